@@ -0,0 +1,148 @@
+// copy-policy.h
+//
+// A memcpy replacement that switches to non-temporal stores above a
+// size threshold. Below the threshold the destination is likely to be
+// read again soon and belongs in cache. Above it, a cached copy only
+// evicts the working set, and streaming stores also skip the read for
+// ownership of every destination line. The break-even point is host
+// specific; simd-copy mode=nt-threshold measures it.
+//
+// Streaming stores are weakly ordered, so every streaming path ends
+// with an sfence before the copy returns.
+
+#ifndef SIMDPERF_COPY_POLICY_H_
+#define SIMDPERF_COPY_POLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <immintrin.h>
+#include "cpu-features.h"
+
+// ----------------------------------------------------------------------------
+//
+// Stores stream whole aligned vectors; a cached head brings the
+// destination up to the vector boundary and a cached tail finishes it.
+inline void stream_copy_sse(void* dst, void const* src, std::size_t bytes)
+{
+	char* d = static_cast<char*>(dst);
+	char const* s = static_cast<char const*>(src);
+	std::size_t head = (16 - reinterpret_cast<std::uintptr_t>(d) % 16) % 16;
+	head = head < bytes ? head : bytes;
+	std::memcpy(d, s, head);
+	d += head;
+	s += head;
+	bytes -= head;
+
+	for(; bytes >= 64; bytes -= 64, d += 64, s += 64)
+	{
+		__m128 v0 = _mm_loadu_ps(reinterpret_cast<float const*>(s));
+		__m128 v1 = _mm_loadu_ps(reinterpret_cast<float const*>(s + 16));
+		__m128 v2 = _mm_loadu_ps(reinterpret_cast<float const*>(s + 32));
+		__m128 v3 = _mm_loadu_ps(reinterpret_cast<float const*>(s + 48));
+		_mm_stream_ps(reinterpret_cast<float*>(d), v0);
+		_mm_stream_ps(reinterpret_cast<float*>(d + 16), v1);
+		_mm_stream_ps(reinterpret_cast<float*>(d + 32), v2);
+		_mm_stream_ps(reinterpret_cast<float*>(d + 48), v3);
+	}
+
+	for(; bytes >= 16; bytes -= 16, d += 16, s += 16)
+		_mm_stream_ps(reinterpret_cast<float*>(d), _mm_loadu_ps(reinterpret_cast<float const*>(s)));
+
+	_mm_sfence();
+	std::memcpy(d, s, bytes);
+}
+
+SIMDPERF_TARGET("avx")
+inline void stream_copy_avx(void* dst, void const* src, std::size_t bytes)
+{
+	char* d = static_cast<char*>(dst);
+	char const* s = static_cast<char const*>(src);
+	std::size_t head = (32 - reinterpret_cast<std::uintptr_t>(d) % 32) % 32;
+	head = head < bytes ? head : bytes;
+	std::memcpy(d, s, head);
+	d += head;
+	s += head;
+	bytes -= head;
+
+	for(; bytes >= 128; bytes -= 128, d += 128, s += 128)
+	{
+		__m256 v0 = _mm256_loadu_ps(reinterpret_cast<float const*>(s));
+		__m256 v1 = _mm256_loadu_ps(reinterpret_cast<float const*>(s + 32));
+		__m256 v2 = _mm256_loadu_ps(reinterpret_cast<float const*>(s + 64));
+		__m256 v3 = _mm256_loadu_ps(reinterpret_cast<float const*>(s + 96));
+		_mm256_stream_ps(reinterpret_cast<float*>(d), v0);
+		_mm256_stream_ps(reinterpret_cast<float*>(d + 32), v1);
+		_mm256_stream_ps(reinterpret_cast<float*>(d + 64), v2);
+		_mm256_stream_ps(reinterpret_cast<float*>(d + 96), v3);
+	}
+
+	for(; bytes >= 32; bytes -= 32, d += 32, s += 32)
+		_mm256_stream_ps(reinterpret_cast<float*>(d), _mm256_loadu_ps(reinterpret_cast<float const*>(s)));
+
+	_mm_sfence();
+	std::memcpy(d, s, bytes);
+}
+
+inline void stream_copy(void* dst, void const* src, std::size_t bytes, unsigned features)
+{
+	if(features & kCpuAvx)
+		stream_copy_avx(dst, src, bytes);
+	else
+		stream_copy_sse(dst, src, bytes);
+}
+
+// ----------------------------------------------------------------------------
+//
+// Half the largest cache, for hosts that have not been tuned. Falls
+// back to 4 MiB when sysfs does not describe the caches.
+inline std::size_t default_nt_threshold()
+{
+	std::size_t largest = 0;
+	for(int index = 0; index < 8; ++index)
+	{
+		char path[128];
+		std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+		std::FILE* f = std::fopen(path, "r");
+		if(!f)
+			break;
+
+		unsigned long size = 0;
+		char unit = 0;
+		if(std::fscanf(f, "%lu%c", &size, &unit) >= 1)
+		{
+			if(unit == 'K')
+				size *= 1024;
+			else if(unit == 'M')
+				size *= 1024 * 1024;
+
+			largest = size > largest ? size : largest;
+		}
+
+		std::fclose(f);
+	}
+
+	return largest ? largest / 2 : 4 * 1024 * 1024;
+}
+
+struct copy_policy
+{
+	copy_policy(std::size_t nt_threshold = default_nt_threshold(), unsigned features = cpu_features())
+		: nt_threshold(nt_threshold)
+		, features(features)
+	{}
+
+	std::size_t nt_threshold; // copies of at least this many bytes stream
+	unsigned features;        // cpu_feature mask the streaming path may use
+};
+
+inline void copy(void* dst, void const* src, std::size_t bytes, copy_policy const& policy)
+{
+	if(bytes >= policy.nt_threshold)
+		stream_copy(dst, src, bytes, policy.features);
+	else
+		std::memcpy(dst, src, bytes);
+}
+
+#endif // SIMDPERF_COPY_POLICY_H_
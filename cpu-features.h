@@ -0,0 +1,239 @@
+// cpu-features.h
+//
+// Runtime ISA detection with CPUID and XGETBV, so one binary can carry
+// kernels for every instruction set and only run the ones the host and
+// its OS support. ISA specific kernels are compiled with
+// SIMDPERF_TARGET instead of global -m flags.
+
+#ifndef SIMDPERF_CPU_FEATURES_H_
+#define SIMDPERF_CPU_FEATURES_H_
+
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#ifdef _MSC_VER
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+#if defined(__GNUC__)
+#  define SIMDPERF_TARGET(isa) __attribute__((target(isa)))
+#else
+#  define SIMDPERF_TARGET(isa)
+#endif
+
+// Keeps the compiler from recognising a copy loop and replacing it with
+// a call to the very memcpy it is being compared with.
+#if defined(__clang__)
+#  define SIMDPERF_NO_MEMCPY_IDIOM __attribute__((no_builtin("memcpy")))
+#elif defined(__GNUC__)
+#  define SIMDPERF_NO_MEMCPY_IDIOM __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#  define SIMDPERF_NO_MEMCPY_IDIOM
+#endif
+
+// Auto-vectorizes a plain loop at -O2, where GCC otherwise leaves it
+// scalar. GCC keeps only the last optimize attribute on a function, so
+// this one repeats the memcpy idiom option and goes after
+// SIMDPERF_NO_MEMCPY_IDIOM. Clang already vectorizes at -O2.
+#if defined(__GNUC__) && !defined(__clang__)
+#  define SIMDPERF_VECTORIZE __attribute__((optimize("tree-vectorize", \
+	"vect-cost-model=dynamic", "no-tree-loop-distribute-patterns")))
+#else
+#  define SIMDPERF_VECTORIZE
+#endif
+
+// ----------------------------------------------------------------------------
+//
+enum cpu_feature
+{
+	kCpuSse2       = 1 << 0,
+	kCpuSse41      = 1 << 1,
+	kCpuAvx        = 1 << 2,
+	kCpuAvx2       = 1 << 3,
+	kCpuFma        = 1 << 4,
+	kCpuAvx512f    = 1 << 5,
+	kCpuAvx512bw   = 1 << 6,
+	kCpuAvx512vl   = 1 << 7,
+	kCpuErms       = 1 << 8,
+	kCpuFsrm       = 1 << 9,
+	kCpuPrfchw     = 1 << 10,
+	kCpuF16c       = 1 << 11,
+	kCpuAvx512bf16 = 1 << 12,
+	kCpuFeatureEnd = 1 << 13
+};
+
+inline char const* cpu_feature_name(unsigned feature)
+{
+	switch(feature)
+	{
+	case kCpuSse2:       return "sse2";
+	case kCpuSse41:      return "sse4.1";
+	case kCpuAvx:        return "avx";
+	case kCpuAvx2:       return "avx2";
+	case kCpuFma:        return "fma";
+	case kCpuAvx512f:    return "avx512f";
+	case kCpuAvx512bw:   return "avx512bw";
+	case kCpuAvx512vl:   return "avx512vl";
+	case kCpuErms:       return "erms";
+	case kCpuFsrm:       return "fsrm";
+	case kCpuPrfchw:     return "prfchw";
+	case kCpuF16c:       return "f16c";
+	case kCpuAvx512bf16: return "avx512bf16";
+	}
+
+	return "unknown";
+}
+
+// ----------------------------------------------------------------------------
+//
+inline void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+	__cpuidex(reinterpret_cast<int*>(regs), leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+inline std::uint64_t xgetbv0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+inline unsigned detect_cpu_features()
+{
+	unsigned features = 0;
+	unsigned int regs[4];
+
+	cpuid(0, 0, regs);
+	unsigned int max_leaf = regs[0];
+	if(max_leaf < 1)
+		return features;
+
+	cpuid(1, 0, regs);
+	if(regs[3] & (1u << 26))
+		features |= kCpuSse2;
+	if(regs[2] & (1u << 19))
+		features |= kCpuSse41;
+
+	// The OS has to save the wider register state on context switches
+	// before any of the VEX or EVEX encoded instructions are usable.
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	std::uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+	bool os_ymm = (xcr0 & 0x6) == 0x6;
+	bool os_zmm = (xcr0 & 0xe6) == 0xe6;
+
+	if(os_ymm && (regs[2] & (1u << 28)))
+		features |= kCpuAvx;
+	if(os_ymm && (regs[2] & (1u << 12)))
+		features |= kCpuFma;
+	if(os_ymm && (regs[2] & (1u << 29)))
+		features |= kCpuF16c;
+
+	if(max_leaf >= 7)
+	{
+		cpuid(7, 0, regs);
+		if(os_ymm && (regs[1] & (1u << 5)))
+			features |= kCpuAvx2;
+		if(os_zmm && (regs[1] & (1u << 16)))
+			features |= kCpuAvx512f;
+		if(os_zmm && (regs[1] & (1u << 30)))
+			features |= kCpuAvx512bw;
+		if(os_zmm && (regs[1] & (1u << 31)))
+			features |= kCpuAvx512vl;
+		if(regs[1] & (1u << 9))
+			features |= kCpuErms;
+		if(regs[3] & (1u << 4))
+			features |= kCpuFsrm;
+
+		if(regs[0] >= 1)
+		{
+			cpuid(7, 1, regs);
+			if(os_zmm && (regs[0] & (1u << 5)))
+				features |= kCpuAvx512bf16;
+		}
+	}
+
+	cpuid(0x80000000, 0, regs);
+	if(regs[0] >= 0x80000001)
+	{
+		cpuid(0x80000001, 0, regs);
+		if(regs[2] & (1u << 8))
+			features |= kCpuPrfchw;
+	}
+
+	return features;
+}
+
+inline unsigned cpu_features()
+{
+	static unsigned const features = detect_cpu_features();
+	return features;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Parses a comma separated list of feature names, such as the ones
+// print_cpu_features writes, into a mask.
+inline bool parse_cpu_features(std::string const& list, unsigned& mask)
+{
+	mask = 0;
+	std::istringstream in(list);
+	std::string name;
+	while(std::getline(in, name, ','))
+	{
+		if(name.empty())
+			continue;
+
+		unsigned feature = 1;
+		while(feature != kCpuFeatureEnd && name != cpu_feature_name(feature))
+			feature <<= 1;
+
+		if(feature == kCpuFeatureEnd)
+			return false;
+
+		mask |= feature;
+	}
+
+	return true;
+}
+
+// Adds every feature that builds on one in mask, so that disabling avx
+// also disables avx2, fma, f16c and avx512.
+inline unsigned with_dependent_features(unsigned mask)
+{
+	if(mask & kCpuSse2)
+		mask |= kCpuSse41;
+	if(mask & kCpuSse41)
+		mask |= kCpuAvx;
+	if(mask & kCpuAvx)
+		mask |= kCpuAvx2 | kCpuFma | kCpuF16c | kCpuAvx512f;
+	if(mask & kCpuAvx512f)
+		mask |= kCpuAvx512bw | kCpuAvx512vl | kCpuAvx512bf16;
+
+	return mask;
+}
+
+inline void print_cpu_features(std::ostream& out, unsigned features)
+{
+	char const* separator = "";
+	for(unsigned feature = 1; feature != kCpuFeatureEnd; feature <<= 1)
+	{
+		if(features & feature)
+		{
+			out << separator << cpu_feature_name(feature);
+			separator = ",";
+		}
+	}
+}
+
+#endif // SIMDPERF_CPU_FEATURES_H_
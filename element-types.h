@@ -0,0 +1,134 @@
+// element-types.h
+//
+// Element types for the types mode. Each traits struct names one
+// storage type and gives the scalar conversions and product the typed
+// kernels and their validation share:
+//
+//   float, double  IEEE binary32 and binary64
+//   int32, int16,  two's complement; the product keeps the low bits, as
+//   int8           _mm256_mullo_epi32 and _mm256_mullo_epi16 do
+//                  and narrowing from_float truncates through int64
+//                  and wraps the same way
+//   half           IEEE binary16 held in a uint16_t, converted with
+//                  F16C; the product is taken in float and rounded back
+//   bf16           bfloat16, the top half of a binary32, held in a
+//                  uint16_t; widening is a shift and narrowing rounds to
+//                  nearest even in integer arithmetic
+
+#ifndef SIMDPERF_ELEMENT_TYPES_H_
+#define SIMDPERF_ELEMENT_TYPES_H_
+
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include "cpu-features.h"
+
+// ----------------------------------------------------------------------------
+//
+SIMDPERF_TARGET("f16c")
+inline float half_to_float(std::uint16_t h)
+{
+	return _cvtsh_ss(h);
+}
+
+SIMDPERF_TARGET("f16c")
+inline std::uint16_t float_to_half(float f)
+{
+	return _cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+}
+
+inline float bf16_to_float(std::uint16_t h)
+{
+	std::uint32_t bits = std::uint32_t(h) << 16;
+	float f;
+	std::memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+// Rounds to nearest even. A NaN is quieted and truncated instead, as
+// the hardware conversion does, since rounding its payload up can
+// carry into the exponent or the sign.
+inline std::uint16_t float_to_bf16(float f)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &f, sizeof(bits));
+	if((bits & 0x7fffffff) > 0x7f800000)
+		return std::uint16_t((bits >> 16) | 0x40);
+
+	bits += 0x7fff + ((bits >> 16) & 1);
+	return std::uint16_t(bits >> 16);
+}
+
+// ----------------------------------------------------------------------------
+//
+struct f32_element
+{
+	typedef float type;
+	static char const* name() { return "float"; }
+	static unsigned isa() { return 0; }
+	static type from_float(float f) { return f; }
+	static double to_double(type v) { return v; }
+	static type mul(type a, type b) { return a * b; }
+};
+
+struct f64_element
+{
+	typedef double type;
+	static char const* name() { return "double"; }
+	static unsigned isa() { return 0; }
+	static type from_float(float f) { return f; }
+	static double to_double(type v) { return v; }
+	static type mul(type a, type b) { return a * b; }
+};
+
+struct i32_element
+{
+	typedef std::int32_t type;
+	static char const* name() { return "int32"; }
+	static unsigned isa() { return 0; }
+	static type from_float(float f) { return type(std::uint32_t(std::int64_t(f))); }
+	static double to_double(type v) { return v; }
+	static type mul(type a, type b) { return type(std::uint32_t(a) * std::uint32_t(b)); }
+};
+
+struct i16_element
+{
+	typedef std::int16_t type;
+	static char const* name() { return "int16"; }
+	static unsigned isa() { return 0; }
+	static type from_float(float f) { return type(std::int64_t(f)); }
+	static double to_double(type v) { return v; }
+	static type mul(type a, type b) { return type(std::uint32_t(a) * std::uint32_t(b)); }
+};
+
+struct i8_element
+{
+	typedef std::int8_t type;
+	static char const* name() { return "int8"; }
+	static unsigned isa() { return 0; }
+	static type from_float(float f) { return type(std::int64_t(f)); }
+	static double to_double(type v) { return v; }
+	static type mul(type a, type b) { return type(std::uint32_t(a) * std::uint32_t(b)); }
+};
+
+struct f16_element
+{
+	typedef std::uint16_t type;
+	static char const* name() { return "half"; }
+	static unsigned isa() { return kCpuF16c; }
+	static type from_float(float f) { return float_to_half(f); }
+	static double to_double(type v) { return half_to_float(v); }
+	static type mul(type a, type b) { return float_to_half(half_to_float(a) * half_to_float(b)); }
+};
+
+struct bf16_element
+{
+	typedef std::uint16_t type;
+	static char const* name() { return "bf16"; }
+	static unsigned isa() { return 0; }
+	static type from_float(float f) { return float_to_bf16(f); }
+	static double to_double(type v) { return bf16_to_float(v); }
+	static type mul(type a, type b) { return float_to_bf16(bf16_to_float(a) * bf16_to_float(b)); }
+};
+
+#endif // SIMDPERF_ELEMENT_TYPES_H_
@@ -0,0 +1,148 @@
+// memcpy-impls.h
+//
+// memcpy implementations to compare side by side. The libc ones are
+// looked up at run time so one binary reports whatever the host libc
+// has: the ifunc resolved memcpy, memmove, the pre-2.14 versioned
+// memcpy, and glibc's per-ISA variants (__memcpy_avx_unaligned_erms and
+// friends) when the build exports them, which distribution builds do
+// not. A shared library named on the command line, such as a custom or
+// libc-free memcpy, is searched the same way.
+//
+// portable_memcpy is the bundled baseline: word-at-a-time C++ with no
+// ISA specific code.
+
+#ifndef SIMDPERF_MEMCPY_IMPLS_H_
+#define SIMDPERF_MEMCPY_IMPLS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#  include <dlfcn.h>
+#endif
+#include "cpu-features.h"
+
+// Fixed size word moves inside such a function. On Clang no_builtin
+// also turns std::memcpy into a libc call; the builtin stays inline.
+#if defined(__GNUC__)
+#  define SIMDPERF_WORD_MEMCPY __builtin_memcpy
+#else
+#  define SIMDPERF_WORD_MEMCPY std::memcpy
+#endif
+
+typedef void* (*memcpy_fn)(void*, void const*, std::size_t);
+
+struct memcpy_impl
+{
+	std::string name;
+	memcpy_fn fn;
+};
+
+// ----------------------------------------------------------------------------
+//
+SIMDPERF_NO_MEMCPY_IDIOM
+inline void* portable_memcpy(void* dst, void const* src, std::size_t bytes)
+{
+	unsigned char* d = static_cast<unsigned char*>(dst);
+	unsigned char const* s = static_cast<unsigned char const*>(src);
+	for(; bytes >= 4 * sizeof(std::uint64_t); bytes -= 4 * sizeof(std::uint64_t))
+	{
+		std::uint64_t w[4];
+		for(int i = 0; i < 4; ++i)
+		{
+			SIMDPERF_WORD_MEMCPY(&w[i], s, sizeof(w[i]));
+			s += sizeof(w[i]);
+		}
+
+		for(int i = 0; i < 4; ++i)
+		{
+			SIMDPERF_WORD_MEMCPY(d, &w[i], sizeof(w[i]));
+			d += sizeof(w[i]);
+		}
+	}
+
+	for(; bytes > 0; --bytes)
+		*d++ = *s++;
+
+	return dst;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Appends every symbol in names that handle resolves, prefixed with
+// prefix. handle is RTLD_DEFAULT for the libc already loaded.
+inline void find_memcpys(void* handle, char const* prefix, std::vector<std::string> const& names, std::vector<memcpy_impl>& impls)
+{
+#ifdef __linux__
+	for(std::string const& name : names)
+	{
+		void* symbol = dlsym(handle, name.c_str());
+		if(symbol)
+			impls.push_back(memcpy_impl{ prefix + name, reinterpret_cast<memcpy_fn>(symbol) });
+	}
+#else
+	(void)handle;
+	(void)prefix;
+	(void)names;
+	(void)impls;
+#endif
+}
+
+inline void find_libc_memcpys(std::vector<memcpy_impl>& impls)
+{
+	impls.push_back(memcpy_impl{ "libc memcpy", &std::memcpy });
+#ifdef __linux__
+	find_memcpys(RTLD_DEFAULT, "libc ", {
+		"memmove",
+		"__memcpy_avx512_unaligned_erms",
+		"__memcpy_avx512_no_vzeroupper",
+		"__memcpy_evex_unaligned_erms",
+		"__memcpy_avx_unaligned_erms",
+		"__memcpy_avx_unaligned",
+		"__memcpy_sse2_unaligned_erms",
+		"__memcpy_sse2_unaligned",
+		"__memcpy_ssse3",
+		"__memcpy_erms",
+	}, impls);
+
+#  ifdef __GLIBC__
+	// memcpy before 2.14 was memmove; old binaries still bind to it.
+	if(void* symbol = dlvsym(RTLD_DEFAULT, "memcpy", "GLIBC_2.2.5"))
+		impls.push_back(memcpy_impl{ "libc memcpy@GLIBC_2.2.5", reinterpret_cast<memcpy_fn>(symbol) });
+#  endif
+#endif
+}
+
+// Loads library and appends the comma separated symbols it exports.
+// false if the library cannot be loaded.
+inline bool find_library_memcpys(std::string const& library, std::string const& symbols, std::vector<memcpy_impl>& impls)
+{
+#ifdef __linux__
+	void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if(!handle)
+		return false;
+
+	std::vector<std::string> names;
+	std::istringstream in(symbols);
+	std::string name;
+	while(std::getline(in, name, ','))
+	{
+		if(!name.empty())
+			names.push_back(name);
+	}
+
+	// The library stays loaded for the life of the process.
+	find_memcpys(handle, (library + " ").c_str(), names, impls);
+	return true;
+#else
+	(void)library;
+	(void)symbols;
+	(void)impls;
+	return false;
+#endif
+}
+
+#endif // SIMDPERF_MEMCPY_IMPLS_H_
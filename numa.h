@@ -0,0 +1,141 @@
+// numa.h
+//
+// NUMA node discovery from sysfs and node bound buffers. Binding goes
+// through the raw mbind and move_pages syscalls so there is no libnuma
+// dependency. A buffer is bound with MPOL_BIND before it is first
+// touched, so every page faults in on the requested node, and
+// numa_page_node() asks the kernel where a page really ended up.
+
+#ifndef SIMDPERF_NUMA_H_
+#define SIMDPERF_NUMA_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "pages.h"
+#include "threads.h"
+#ifdef __linux__
+#  include <linux/mempolicy.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------
+//
+// Reads a one line sysfs file such as a cpu or node list.
+inline std::string read_sysfs_line(char const* path)
+{
+	std::string line;
+	std::FILE* f = std::fopen(path, "r");
+	if(!f)
+		return line;
+
+	char buffer[4096];
+	if(std::fgets(buffer, sizeof(buffer), f))
+		line = buffer;
+
+	std::fclose(f);
+	while(!line.empty() && (line.back() == '\n' || line.back() == ' '))
+		line.pop_back();
+
+	return line;
+}
+
+// The online nodes; just node 0 when the kernel does not expose any.
+inline std::vector<int> numa_nodes()
+{
+	std::vector<int> nodes;
+	if(!parse_cpu_list(read_sysfs_line("/sys/devices/system/node/online"), nodes) || nodes.empty())
+		nodes.assign(1, 0);
+
+	return nodes;
+}
+
+inline std::vector<int> numa_node_cpus(int node)
+{
+	char path[128];
+	std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+	std::vector<int> cpus;
+	if(!parse_cpu_list(read_sysfs_line(path), cpus))
+		cpus.clear();
+
+	return cpus;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Binds the pages covering [p, p + bytes) to node. p must be page
+// aligned. Pages that were already touched elsewhere are migrated.
+inline bool numa_bind(void* p, std::size_t bytes, int node)
+{
+#ifdef __linux__
+	std::size_t const bits = 8 * sizeof(unsigned long);
+	std::vector<unsigned long> mask(node / bits + 1, 0);
+	mask[node / bits] = 1ul << (node % bits);
+
+	// maxnode counts one past the last bit the kernel should read.
+	long result = syscall(__NR_mbind, p, bytes, MPOL_BIND, mask.data(), mask.size() * bits + 1, MPOL_MF_STRICT | MPOL_MF_MOVE);
+	return result == 0;
+#else
+	(void)p;
+	(void)bytes;
+	(void)node;
+	return false;
+#endif
+}
+
+// The node backing the page at p, or -1 if it is not known.
+inline int numa_page_node(void const* p)
+{
+#ifdef __linux__
+	void* page = const_cast<void*>(p);
+	int status = -1;
+	if(syscall(__NR_move_pages, 0, 1ul, &page, nullptr, &status, 0) != 0 || status < 0)
+		return -1;
+
+	return status;
+#else
+	(void)p;
+	return -1;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+//
+// A page buffer bound to one node. bound() is false when the binding
+// was refused, in which case the buffer is still usable but its pages
+// go wherever the default policy puts them.
+class numa_buffer
+{
+public:
+	numa_buffer(std::size_t bytes, int node, page_kind kind = page_kind::system)
+		: pages_(bytes, kind)
+		, bound_(false)
+	{
+		if(pages_.data<void>())
+			bound_ = numa_bind(pages_.data<void>(), pages_.size(), node);
+	}
+
+	template<typename T>
+	T* data() const
+	{
+		return pages_.data<T>();
+	}
+
+	std::size_t size() const
+	{
+		return pages_.size();
+	}
+
+	bool bound() const
+	{
+		return bound_;
+	}
+
+private:
+	page_buffer pages_;
+	bool bound_;
+};
+
+#endif // SIMDPERF_NUMA_H_
@@ -0,0 +1,221 @@
+// pages.h
+//
+// Page backed buffers for the DRAM sized modes. A buffer is an anonymous
+// mapping backed by one of:
+//
+//   default  whatever the system THP policy gives a plain mapping
+//   4k       regular pages, with THP turned off for the range
+//   thp      transparent huge pages requested with MADV_HUGEPAGE on a
+//            2 MiB aligned range
+//   2m, 1g   explicit MAP_HUGETLB pages; these need pages reserved in
+//            /sys/kernel/mm/hugepages and fail cleanly when there are
+//            not enough
+//
+// A new mapping has no pages behind it until it is first written, so
+// the first pass over it pays a fault per page unless the mapping was
+// populated up front or prefaulted.
+
+#ifndef SIMDPERF_PAGES_H_
+#define SIMDPERF_PAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include "placement.h"
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#  define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MADV_POPULATE_WRITE
+#  define MADV_POPULATE_WRITE 23
+#endif
+
+std::size_t const kGiantPageBytes = 1024 * 1024 * 1024;
+
+// ----------------------------------------------------------------------------
+//
+enum class page_kind
+{
+	system,
+	small,
+	thp,
+	huge_2m,
+	huge_1g,
+};
+
+inline bool parse_page_kind(std::string const& name, page_kind& kind)
+{
+	if(name == "default")
+		kind = page_kind::system;
+	else if(name == "4k")
+		kind = page_kind::small;
+	else if(name == "thp")
+		kind = page_kind::thp;
+	else if(name == "2m")
+		kind = page_kind::huge_2m;
+	else if(name == "1g")
+		kind = page_kind::huge_1g;
+	else
+		return false;
+
+	return true;
+}
+
+inline char const* page_kind_name(page_kind kind)
+{
+	switch(kind)
+	{
+	case page_kind::system:  return "default";
+	case page_kind::small:   return "4k";
+	case page_kind::thp:     return "thp";
+	case page_kind::huge_2m: return "2m";
+	case page_kind::huge_1g: return "1g";
+	}
+
+	return "unknown";
+}
+
+// The granule a mapping of this kind is sized and aligned to.
+inline std::size_t page_kind_bytes(page_kind kind)
+{
+	switch(kind)
+	{
+	case page_kind::thp:
+	case page_kind::huge_2m: return kHugePageBytes;
+	case page_kind::huge_1g: return kGiantPageBytes;
+	default:                 return kPageBytes;
+	}
+}
+
+// When the destination's pages are faulted in, for the first touch mode.
+enum class fault_policy
+{
+	cold,     // by the kernel that writes it
+	populate, // when mapped, with MAP_POPULATE or MADV_POPULATE_WRITE
+	prefault, // by a team of threads touching every page before the kernel
+	warm,     // once, outside the timed region
+};
+
+inline char const* fault_policy_name(fault_policy policy)
+{
+	switch(policy)
+	{
+	case fault_policy::cold:     return "cold";
+	case fault_policy::populate: return "populate";
+	case fault_policy::prefault: return "prefault";
+	case fault_policy::warm:     return "warm";
+	}
+
+	return "unknown";
+}
+
+// Writes one byte in every page of [p, p + bytes) to fault it in.
+inline void touch_pages(void* p, std::size_t bytes, std::size_t page_bytes)
+{
+	volatile char* c = static_cast<char*>(p);
+	for(std::size_t i = 0; i < bytes; i += page_bytes)
+		c[i] = 0;
+}
+
+// ----------------------------------------------------------------------------
+//
+// data() is null when the mapping could not be made, which for the
+// hugetlb kinds usually means too few reserved pages.
+class page_buffer
+{
+public:
+	page_buffer(std::size_t bytes, page_kind kind, bool populate = false)
+		: kind_(kind)
+		, mapping_(nullptr)
+		, mapped_bytes_(0)
+		, data_(nullptr)
+		, bytes_(0)
+	{
+		std::size_t const granule = page_kind_bytes(kind);
+		bytes_ = (bytes + granule - 1) / granule * granule;
+#ifdef __linux__
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+		if(kind == page_kind::huge_2m)
+			flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+		else if(kind == page_kind::huge_1g)
+			flags |= MAP_HUGETLB | (30 << MAP_HUGE_SHIFT);
+
+		// Only hugetlb mappings populate in mmap. The others would fault
+		// in before madvise picks their page size, so populate below.
+		bool const hugetlb = kind == page_kind::huge_2m || kind == page_kind::huge_1g;
+		if(populate && hugetlb)
+			flags |= MAP_POPULATE;
+
+		// THP only backs 2 MiB aligned runs, so map a spare huge page
+		// and start the buffer on the first boundary inside it.
+		mapped_bytes_ = kind == page_kind::thp ? bytes_ + granule : bytes_;
+		void* p = mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, flags, -1, 0);
+		if(p == MAP_FAILED)
+			return;
+
+		mapping_ = p;
+		std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+		address = (address + granule - 1) & ~std::uintptr_t(granule - 1);
+		data_ = reinterpret_cast<void*>(address);
+
+		if(kind == page_kind::thp)
+			madvise(data_, bytes_, MADV_HUGEPAGE);
+		else if(kind == page_kind::small)
+			madvise(data_, bytes_, MADV_NOHUGEPAGE);
+
+		// MADV_POPULATE_WRITE needs Linux 5.14; older kernels reject it
+		// and the pages are touched instead.
+		if(populate && !hugetlb && madvise(data_, bytes_, MADV_POPULATE_WRITE) != 0)
+			touch_pages(data_, bytes_, kPageBytes);
+#else
+		(void)populate;
+		if(kind == page_kind::system || kind == page_kind::small)
+		{
+			mapping_ = std::malloc(bytes_);
+			data_ = mapping_;
+		}
+#endif
+	}
+
+	~page_buffer()
+	{
+#ifdef __linux__
+		if(mapping_)
+			munmap(mapping_, mapped_bytes_);
+#else
+		std::free(mapping_);
+#endif
+	}
+
+	page_buffer(page_buffer const&) = delete;
+	page_buffer& operator=(page_buffer const&) = delete;
+
+	template<typename T>
+	T* data() const
+	{
+		return static_cast<T*>(data_);
+	}
+
+	std::size_t size() const
+	{
+		return bytes_;
+	}
+
+	page_kind kind() const
+	{
+		return kind_;
+	}
+
+private:
+	page_kind kind_;
+	void* mapping_;
+	std::size_t mapped_bytes_;
+	void* data_;
+	std::size_t bytes_;
+};
+
+#endif // SIMDPERF_PAGES_H_
@@ -0,0 +1,419 @@
+// perf-counters.h
+//
+// Hardware performance counters via Linux perf_event_open. Events are
+// opened in small groups so that the ones in a group are always
+// scheduled together; groups that the kernel had to multiplex are
+// scaled by time_enabled / time_running. Events the host or the
+// current privilege level does not support are reported as NaN rather
+// than failing the run.
+//
+// Store-forwarding blocks and split loads/stores are Intel raw events
+// (LD_BLOCKS.STORE_FORWARD, MEM_INST_RETIRED.SPLIT_LOADS/STORES) whose
+// encodings are stable from Sandy Bridge through Ice Lake. DRAM traffic
+// comes from the uncore_imc_* PMUs when they are exposed in sysfs,
+// summed over every socket, and needs system-wide counting rights
+// (perf_event_paranoid <= 0 or CAP_PERFMON).
+
+#ifndef SIMDPERF_PERF_COUNTERS_H_
+#define SIMDPERF_PERF_COUNTERS_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#  include <cpuid.h>
+#  include <cstdio>
+#  include <cstring>
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------
+//
+enum perf_event_id
+{
+	kPerfCycles,
+	kPerfInstructions,
+	kPerfL1dMisses,
+	kPerfLlcMisses,
+	kPerfDtlbMisses,
+	kPerfStoreForwardBlocks,
+	kPerfSplitLoads,
+	kPerfSplitStores,
+	kPerfDramReadLines,
+	kPerfDramWriteLines,
+	kPerfEventCount
+};
+
+struct perf_sample
+{
+	perf_sample()
+	{
+		for(double& v : values)
+			v = std::numeric_limits<double>::quiet_NaN();
+	}
+
+	double operator[](perf_event_id id) const
+	{
+		return values[id];
+	}
+
+	double values[kPerfEventCount];
+};
+
+// Prints the derived figures; bytes is the data volume the kernel
+// moved, used to normalise misses to per-cacheline rates, and seconds
+// the wall time of the counted run, which gives the effective core
+// clock (and so any wide-vector frequency drop).
+inline void print_perf_sample(std::ostream& out, perf_sample const& sample, double bytes, double seconds)
+{
+	double lines = bytes / 64;
+	out << "ipc " << sample[kPerfInstructions] / sample[kPerfCycles]
+		<< " core-ghz " << sample[kPerfCycles] / seconds / 1e9
+		<< " l1d-miss/line " << sample[kPerfL1dMisses] / lines
+		<< " llc-miss/line " << sample[kPerfLlcMisses] / lines
+		<< " dtlb-miss/line " << sample[kPerfDtlbMisses] / lines
+		<< " sf-block/line " << sample[kPerfStoreForwardBlocks] / lines
+		<< " split-load/line " << sample[kPerfSplitLoads] / lines
+		<< " split-store/line " << sample[kPerfSplitStores] / lines
+		<< " dram-read/line " << sample[kPerfDramReadLines] / lines
+		<< " dram-write/line " << sample[kPerfDramWriteLines] / lines
+	;
+}
+
+#ifdef __linux__
+
+// ----------------------------------------------------------------------------
+//
+class perf_group
+{
+public:
+	explicit perf_group(int pid = 0, int cpu = -1)
+		: pid_(pid)
+		, cpu_(cpu)
+	{}
+
+	perf_group(perf_group&& other)
+		: pid_(other.pid_)
+		, cpu_(other.cpu_)
+		, fds_(std::move(other.fds_))
+		, ids_(std::move(other.ids_))
+	{
+		other.fds_.clear();
+	}
+
+	perf_group(perf_group const&) = delete;
+	perf_group& operator=(perf_group const&) = delete;
+
+	~perf_group()
+	{
+		for(int fd : fds_)
+			close(fd);
+	}
+
+	bool add(perf_event_id id, std::uint32_t type, std::uint64_t config)
+	{
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = fds_.empty();
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		// Uncore PMUs reject the exclude bits.
+		if(pid_ != -1)
+		{
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+		}
+
+		int leader = fds_.empty() ? -1 : fds_.front();
+		int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, pid_, cpu_, leader, 0));
+		if(fd < 0)
+			return false;
+
+		fds_.push_back(fd);
+		ids_.push_back(id);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return fds_.empty();
+	}
+
+	void start()
+	{
+		if(empty())
+			return;
+
+		ioctl(fds_.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds_.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	void stop()
+	{
+		if(empty())
+			return;
+
+		ioctl(fds_.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	// Adds this group's values into sample.
+	void read_into(perf_sample& sample) const
+	{
+		if(empty())
+			return;
+
+		std::vector<std::uint64_t> buffer(3 + fds_.size());
+		ssize_t bytes = ::read(fds_.front(), buffer.data(), buffer.size() * sizeof(std::uint64_t));
+		if(bytes < static_cast<ssize_t>(buffer.size() * sizeof(std::uint64_t)))
+			return;
+
+		std::uint64_t enabled = buffer[1];
+		std::uint64_t running = buffer[2];
+		if(running == 0)
+			return;
+
+		double scale = static_cast<double>(enabled) / running;
+		for(std::size_t i = 0; i < ids_.size(); ++i)
+		{
+			double& v = sample.values[ids_[i]];
+			if(std::isnan(v))
+				v = 0;
+			v += buffer[3 + i] * scale;
+		}
+	}
+
+private:
+	int pid_;
+	int cpu_;
+	std::vector<int> fds_;
+	std::vector<perf_event_id> ids_;
+};
+
+// ----------------------------------------------------------------------------
+//
+inline bool is_genuine_intel()
+{
+	unsigned int eax, ebx, ecx, edx;
+	if(!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+		return false;
+
+	return ebx == 0x756e6547 && edx == 0x49656e69 && ecx == 0x6c65746e;
+}
+
+inline std::uint64_t cache_event(std::uint64_t cache, std::uint64_t op, std::uint64_t result)
+{
+	return cache | (op << 8) | (result << 16);
+}
+
+// Reads an integer sysfs attribute, -1 if it does not exist.
+inline long read_sysfs_long(char const* path)
+{
+	std::FILE* f = std::fopen(path, "r");
+	if(!f)
+		return -1;
+
+	long value = -1;
+	if(std::fscanf(f, "%li", &value) != 1)
+		value = -1;
+
+	std::fclose(f);
+	return value;
+}
+
+// Reads a sysfs cpu list such as a PMU cpumask ("0,28" or "0-3"),
+// empty if it does not exist.
+inline std::vector<int> read_sysfs_cpus(char const* path)
+{
+	std::vector<int> cpus;
+	std::FILE* f = std::fopen(path, "r");
+	if(!f)
+		return cpus;
+
+	int first;
+	while(std::fscanf(f, "%d", &first) == 1)
+	{
+		int last = first;
+		int separator = std::fgetc(f);
+		if(separator == '-' && std::fscanf(f, "%d", &last) == 1)
+			separator = std::fgetc(f);
+
+		for(int cpu = first; cpu <= last; ++cpu)
+			cpus.push_back(cpu);
+
+		if(separator != ',')
+			break;
+	}
+
+	std::fclose(f);
+	return cpus;
+}
+
+// Parses an "event=0x04,umask=0x03" style sysfs event description into
+// a raw config for PMUs that use the standard event/umask layout.
+inline bool read_sysfs_event(char const* path, std::uint64_t& config)
+{
+	std::FILE* f = std::fopen(path, "r");
+	if(!f)
+		return false;
+
+	unsigned int event = 0;
+	unsigned int umask = 0;
+	int matched = std::fscanf(f, "event=%x,umask=%x", &event, &umask);
+	std::fclose(f);
+	if(matched < 1)
+		return false;
+
+	config = event | (umask << 8);
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+//
+class perf_counters
+{
+public:
+	perf_counters()
+	{}
+
+	void open()
+	{
+		perf_group core;
+		core.add(kPerfCycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+		core.add(kPerfInstructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+		add_group(std::move(core));
+
+		perf_group cache;
+		cache.add(kPerfL1dMisses, PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+		cache.add(kPerfLlcMisses, PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+		cache.add(kPerfDtlbMisses, PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+		add_group(std::move(cache));
+
+		if(is_genuine_intel())
+		{
+			perf_group memory;
+			memory.add(kPerfStoreForwardBlocks, PERF_TYPE_RAW, 0x0203);
+			memory.add(kPerfSplitLoads, PERF_TYPE_RAW, 0x41d0);
+			memory.add(kPerfSplitStores, PERF_TYPE_RAW, 0x42d0);
+			add_group(std::move(memory));
+		}
+
+		open_uncore_imc();
+	}
+
+	bool available() const
+	{
+		return !groups_.empty();
+	}
+
+	void start()
+	{
+		for(perf_group& g : groups_)
+			g.start();
+	}
+
+	void stop()
+	{
+		for(perf_group& g : groups_)
+			g.stop();
+	}
+
+	perf_sample read() const
+	{
+		perf_sample sample;
+		for(perf_group const& g : groups_)
+			g.read_into(sample);
+
+		return sample;
+	}
+
+	template<typename Fn>
+	perf_sample count(Fn&& fn)
+	{
+		start();
+		fn();
+		stop();
+		return read();
+	}
+
+private:
+	void add_group(perf_group&& group)
+	{
+		if(!group.empty())
+			groups_.push_back(std::move(group));
+	}
+
+	void open_uncore_imc()
+	{
+		for(int i = 0; i < 32; ++i)
+		{
+			char path[256];
+			std::snprintf(path, sizeof(path), "/sys/bus/event_source/devices/uncore_imc_%d/type", i);
+			long type = read_sysfs_long(path);
+			if(type < 0)
+				break;
+
+			std::uint64_t read_config;
+			std::uint64_t write_config;
+			std::snprintf(path, sizeof(path), "/sys/bus/event_source/devices/uncore_imc_%d/events/cas_count_read", i);
+			bool has_read = read_sysfs_event(path, read_config);
+			std::snprintf(path, sizeof(path), "/sys/bus/event_source/devices/uncore_imc_%d/events/cas_count_write", i);
+			bool has_write = read_sysfs_event(path, write_config);
+
+			// Uncore counters are per socket, not per task. The cpumask
+			// names one cpu in each socket; every socket gets a group and
+			// read() sums them.
+			std::snprintf(path, sizeof(path), "/sys/bus/event_source/devices/uncore_imc_%d/cpumask", i);
+			std::vector<int> cpus = read_sysfs_cpus(path);
+			if(cpus.empty())
+				cpus.push_back(0);
+
+			for(int cpu : cpus)
+			{
+				perf_group imc(-1, cpu);
+				if(has_read)
+					imc.add(kPerfDramReadLines, static_cast<std::uint32_t>(type), read_config);
+				if(has_write)
+					imc.add(kPerfDramWriteLines, static_cast<std::uint32_t>(type), write_config);
+				add_group(std::move(imc));
+			}
+		}
+	}
+
+	std::vector<perf_group> groups_;
+};
+
+#else
+
+class perf_counters
+{
+public:
+	void open()
+	{}
+
+	bool available() const
+	{
+		return false;
+	}
+
+	template<typename Fn>
+	perf_sample count(Fn&& fn)
+	{
+		fn();
+		return perf_sample();
+	}
+};
+
+#endif // __linux__
+
+#endif // SIMDPERF_PERF_COUNTERS_H_
@@ -0,0 +1,75 @@
+// placement.h
+//
+// Buffer placement model. A placement is a power of two base alignment
+// (cache line, page, huge page) plus a byte offset from it. The base is
+// exact: the placed address is aligned to base but not to 2 * base, so
+// a 64 byte placement never silently becomes a page aligned one
+// depending on where the allocator happened to put the buffer.
+
+#ifndef SIMDPERF_PLACEMENT_H_
+#define SIMDPERF_PLACEMENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+std::size_t const kCacheLineBytes = 64;
+std::size_t const kPageBytes = 4096;
+std::size_t const kHugePageBytes = 2 * 1024 * 1024;
+
+struct placement
+{
+	placement(std::size_t base = kCacheLineBytes, std::size_t offset = 0)
+		: base(base)
+		, offset(offset)
+	{}
+
+	std::size_t base;
+	std::size_t offset;
+};
+
+inline bool is_power_of_two(std::size_t value)
+{
+	return value != 0 && (value & (value - 1)) == 0;
+}
+
+// A placement is valid for T when the base is a power of two and the
+// resulting address is still suitably aligned for T.
+template<typename T>
+bool is_valid_placement(placement const& p)
+{
+	return is_power_of_two(p.base) && p.base >= alignof(T) && p.offset % alignof(T) == 0;
+}
+
+// Whether the placed address is a multiple of alignment.
+inline bool is_aligned(placement const& p, std::size_t alignment)
+{
+	return alignment <= 2 * p.base && (p.base + p.offset) % alignment == 0;
+}
+
+// Extra bytes a region needs beyond its payload to hold any placement
+// with this base and offset, plus a cache line of slack past the end
+// for overrun guards.
+inline std::size_t placement_padding(placement const& p)
+{
+	return 2 * p.base + p.offset + kCacheLineBytes;
+}
+
+template<typename T>
+T* place(T* region, placement const& p)
+{
+	std::uintptr_t address = reinterpret_cast<std::uintptr_t>(region);
+	std::uintptr_t const mask = p.base - 1;
+	address = (address + mask) & ~mask;
+	if((address & p.base) == 0)
+		address += p.base;
+
+	return reinterpret_cast<T*>(address + p.offset);
+}
+
+inline std::ostream& operator<<(std::ostream& out, placement const& p)
+{
+	return out << p.base << "+" << p.offset;
+}
+
+#endif // SIMDPERF_PLACEMENT_H_
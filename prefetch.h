@@ -0,0 +1,71 @@
+// prefetch.h
+//
+// Software prefetch with the hint as a template argument, since the
+// instructions take it as an immediate. kPrefetchNone compiles to
+// nothing, so a loop instantiated with it is the baseline for the same
+// loop with each real hint. kPrefetchW is prefetchw, which fetches a
+// line in exclusive state ready to be written and needs kCpuPrfchw.
+
+#ifndef SIMDPERF_PREFETCH_H_
+#define SIMDPERF_PREFETCH_H_
+
+#include <immintrin.h>
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+//
+enum prefetch_hint
+{
+	kPrefetchNone,
+	kPrefetchT0,
+	kPrefetchT1,
+	kPrefetchT2,
+	kPrefetchNta,
+	kPrefetchW,
+};
+
+template<int hint>
+inline void prefetch(void const* p);
+
+template<>
+inline void prefetch<kPrefetchNone>(void const*)
+{}
+
+template<>
+inline void prefetch<kPrefetchT0>(void const* p)
+{
+	_mm_prefetch(static_cast<char const*>(p), _MM_HINT_T0);
+}
+
+template<>
+inline void prefetch<kPrefetchT1>(void const* p)
+{
+	_mm_prefetch(static_cast<char const*>(p), _MM_HINT_T1);
+}
+
+template<>
+inline void prefetch<kPrefetchT2>(void const* p)
+{
+	_mm_prefetch(static_cast<char const*>(p), _MM_HINT_T2);
+}
+
+template<>
+inline void prefetch<kPrefetchNta>(void const* p)
+{
+	_mm_prefetch(static_cast<char const*>(p), _MM_HINT_NTA);
+}
+
+// Emitted directly so the caller does not need the prfchw target.
+template<>
+inline void prefetch<kPrefetchW>(void const* p)
+{
+#ifdef _MSC_VER
+	_m_prefetchw(const_cast<void*>(p));
+#else
+	__asm__ volatile("prefetchw %0" : : "m"(*static_cast<char const*>(p)));
+#endif
+}
+
+#endif // SIMDPERF_PREFETCH_H_
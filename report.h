@@ -0,0 +1,128 @@
+// report.h
+//
+// Google Charts HTML wrapper around the data tables the benchmarks
+// print to stdout. The table itself is written by the caller between
+// html_begin() and html_end().
+//
+// Heatmaps are plain HTML tables instead, corechart has no heatmap;
+// heatmap_table() is called once per kernel between heatmap_begin()
+// and heatmap_end().
+
+#ifndef SIMDPERF_REPORT_H_
+#define SIMDPERF_REPORT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+inline void html_begin(std::ostream& out)
+{
+	out <<
+	   "<html>\n"
+	   "  <head>\n"
+	   "    <script type=\"text/javascript\" src=\"https://www.google.com/jsapi\"></script>\n"
+	   "    <script type=\"text/javascript\">\n"
+	   "      google.load(\"visualization\", \"1\", {packages:[\"corechart\"]});\n"
+	   "      google.setOnLoadCallback(drawChart);\n"
+	   "      function drawChart() {\n"
+	   "        var data = google.visualization.arrayToDataTable([\n"
+	;
+}
+
+// chart is the google.visualization class name, options the body of
+// the javascript options object.
+inline void html_end(std::ostream& out, char const* chart, std::string const& options)
+{
+	out <<
+		"        ]);\n"
+		"        var options = {\n"
+		"          " << options << "\n"
+		"        };\n"
+		"        var chart = new google.visualization." << chart << "(document.getElementById('chart_div'));\n"
+		"        chart.draw(data, options);\n"
+		"      }\n"
+		"    </script>\n"
+		"  </head>\n"
+		"  <body>\n"
+		"    <div id=\"chart_div\" style=\"width: 900px; height: 500px;\"></div>\n"
+		"  </body>\n"
+		"</html>\n"
+	;
+}
+
+// ----------------------------------------------------------------------------
+//
+inline void heatmap_begin(std::ostream& out, char const* title)
+{
+	out <<
+	   "<html>\n"
+	   "  <head>\n"
+	   "    <title>" << title << "</title>\n"
+	   "    <style>\n"
+	   "      table { border-collapse: collapse; margin-bottom: 24px; font: 11px sans-serif; }\n"
+	   "      td, th { padding: 2px 4px; text-align: right; }\n"
+	   "    </style>\n"
+	   "  </head>\n"
+	   "  <body>\n"
+	   "    <h2>" << title << "</h2>\n"
+	;
+}
+
+// values are row major, rows.size() * columns.size() of them. Cells
+// with a zero value were not measured and are left blank. Colours run
+// from red at the table minimum to green at its maximum.
+inline void heatmap_table(std::ostream& out, char const* name, char const* row_label, char const* column_label,
+						  std::vector<std::size_t> const& rows, std::vector<std::size_t> const& columns,
+						  std::vector<double> const& values)
+{
+	double lo = 0;
+	double hi = 0;
+	for(double v : values)
+	{
+		if(v <= 0)
+			continue;
+
+		lo = lo == 0 ? v : std::min(lo, v);
+		hi = std::max(hi, v);
+	}
+
+	out << "    <h3>" << name << "</h3>\n"
+		<< "    <table>\n"
+		<< "      <tr><th>" << row_label << " \\ " << column_label << "</th>";
+	for(std::size_t c : columns)
+		out << "<th>" << c << "</th>";
+	out << "</tr>\n";
+
+	for(std::size_t r = 0; r < rows.size(); ++r)
+	{
+		out << "      <tr><th>" << rows[r] << "</th>";
+		for(std::size_t c = 0; c < columns.size(); ++c)
+		{
+			double v = values[r * columns.size() + c];
+			if(v <= 0)
+			{
+				out << "<td></td>";
+				continue;
+			}
+
+			double t = hi > lo ? (v - lo) / (hi - lo) : 1;
+			out << "<td style=\"background: hsl(" << static_cast<int>(t * 120) << ", 70%, 60%)\">"
+				<< static_cast<int>(v * 10) / 10.0 << "</td>";
+		}
+		out << "</tr>\n";
+	}
+
+	out << "    </table>\n";
+}
+
+inline void heatmap_end(std::ostream& out)
+{
+	out <<
+		"  </body>\n"
+		"</html>\n"
+	;
+}
+
+#endif // SIMDPERF_REPORT_H_
@@ -1,295 +1,2433 @@
 // simd-copy.cpp
 // 
 // cl.exe /EHsc /Ox simd-copy.cpp
-// g++ -std=c++11 -O3 simd-copy.cpp
+// g++ -std=c++11 -O3 simd-copy.cpp -pthread -ldl
 //
-// or
-// 
-// cl.exe /EHsc /Ox /arch:AVX2 simd-copy.cpp
-// g++ -std=c++11 -O3 -march=core-avx2 -mtune=core-avx2 -mavx2 
+// No -march or /arch flags are needed. Kernels that use instructions
+// beyond the baseline carry their own target attributes and are only
+// run when CPUID reports the host supports them.
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <immintrin.h>
 #include <cassert>
 #include "cgutil/program_options.h"
 #include "cgutil/timer.h"
-
-#ifndef SUPPORT_AVX
-#  define SUPPORT_AVX 1
-#endif
-
-template<typename T>
-T* align(T* p, std::size_t aligned_to)
-{
-	std::size_t address = reinterpret_cast<std::size_t>(p);
-	while(address % 256 != aligned_to)
-		++address;
-	return reinterpret_cast<T*>(address);
-}
+#include "copy-policy.h"
+#include "cpu-features.h"
+#include "element-types.h"
+#include "memcpy-impls.h"
+#include "numa.h"
+#include "pages.h"
+#include "perf-counters.h"
+#include "placement.h"
+#include "prefetch.h"
+#include "report.h"
+#include "sweep.h"
+#include "threads.h"
+#include "timing.h"
+#include "trials.h"
+#include "vector-ops.h"
 
 // ----------------------------------------------------------------------------
 //
 std::size_t kDefaultNumFloats = 16 * 1024;
 std::size_t kDefaultTotalFloats = 65636 * kDefaultNumFloats;
+std::size_t const kStreamsPerFloat = 2; // one load, one store
+std::size_t const kGuardFloats = kCacheLineBytes / sizeof(float);
 std::size_t gNumFloats = kDefaultNumFloats;
 std::size_t gTotalFloats = kDefaultTotalFloats;
 float gCheckValue = 1.f;
-bool gHasAvx = true;
+std::size_t gTrials = 7;
+std::size_t gWarmupTrials = 1;
+std::size_t gBootstrapResamples = 1000;
+double gConfidence = 0.95;
+timing_backend gTimingBackend = timing_backend::tsc;
+bool gReportCycles = false;
+bool gCollectCounters = false;
+perf_counters gCounters;
+std::string gMode = "alignment";
+std::size_t gSweepMinBytes = 1024;
+std::size_t gSweepMaxBytes = std::size_t(1) << 30;
+std::size_t gSweepStepsPerOctave = 2;
+std::size_t gSweepTotalFloats = 64 * 1024 * 1024;
+placement gSourcePlacement;
+placement gDestPlacement;
+std::size_t gAliasStep = 64;
+std::size_t gAliasWindow = 64;
+double gAliasThreshold = 0.15;
+unsigned gCpuFeatures = 0;
+std::size_t gTailMaxFloats = 67;
+std::size_t gTailTotalFloats = 1024 * 1024;
+std::size_t gMaxThreads = std::max(1u, std::thread::hardware_concurrency());
+std::size_t gThreadNumFloats = 16 * 1024 * 1024;
+std::size_t gThreadTotalFloats = 64 * 1024 * 1024;
+double gSaturationFraction = 0.95;
+std::size_t gNumaThreads = 1;
+int gNumaCpuNode = -1;
+page_kind gPageKind = page_kind::system;
+std::size_t gPagesNumFloats = 16 * 1024 * 1024;
+std::size_t gPagesTotalFloats = 64 * 1024 * 1024;
+std::size_t gFaultNumFloats = 16 * 1024 * 1024;
+std::size_t gFaultThreads = std::max(1u, std::thread::hardware_concurrency());
+copy_policy gCopyPolicy;
+memcpy_fn gMemcpy = &std::memcpy;
+std::string gMemcpyLibrary;
+std::string gMemcpySymbols = "memcpy";
+std::size_t gPrefetchDistance = 0;
+std::size_t gPrefetchMinDistance = 64;
+std::size_t gPrefetchMaxDistance = 4096;
+std::size_t gStride = 1;
+std::size_t gStrideMin = 1;
+std::size_t gStrideMax = 64;
+std::size_t gStrideTotalFloats = 16 * 1024 * 1024;
 bool gHtmlOut = true;
 
-void MemCopy(float* d, float const* s)
+void MemCopy(float* d, float const* s, std::size_t n)
 {
-	std::memcpy(d, s, gNumFloats * sizeof(float));
+	std::memcpy(d, s, n * sizeof(float));
 }
 
-void StdCopy(float* d, float const* s)
+void StdCopy(float* d, float const* s, std::size_t n)
 {
-	std::copy(s, s + gNumFloats, d);
+	std::copy(s, s + n, d);
 }
 
-void SimpleCopy(float* d, float const* s)
+void SimpleCopy(float* d, float const* s, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; ++i)
+	for(int i = 0; i < n; ++i)
 	{
 		*d++ = *s++;
 	}
 }
 
-void UnalignedSseCopy(float* d, float const* s)
+// Stream with a cached head up to the vector boundary, so the
+// destination needs no particular alignment.
+SIMDPERF_TARGET("sse2")
+void UnalignedSseNonTemporalCopy(float* d, float const* s, std::size_t n)
+{
+	stream_copy_sse(d, s, n * sizeof(float));
+}
+
+SIMDPERF_TARGET("avx")
+void UnalignedAvxNonTemporalCopy(float* d, float const* s, std::size_t n)
+{
+	stream_copy_avx(d, s, n * sizeof(float));
+}
+
+// std::memcpy below the non-temporal threshold, streaming above it.
+void PolicyCopy(float* d, float const* s, std::size_t n)
+{
+	copy(d, s, n * sizeof(float), gCopyPolicy);
+}
+
+// String instruction copies. rep movsb is the form ERMS and FSRM
+// speed up in microcode; movsd and movsq move 4 and 8 bytes per step,
+// with movsq leaving an odd float to a scalar tail.
+void RepMovsbCopy(float* d, float const* s, std::size_t n)
+{
+	std::size_t bytes = n * sizeof(float);
+#ifdef _MSC_VER
+	__movsb(reinterpret_cast<unsigned char*>(d), reinterpret_cast<unsigned char const*>(s), bytes);
+#else
+	__asm__ volatile("rep movsb" : "+D"(d), "+S"(s), "+c"(bytes) : : "memory");
+#endif
+}
+
+void RepMovsdCopy(float* d, float const* s, std::size_t n)
+{
+#ifdef _MSC_VER
+	__movsd(reinterpret_cast<unsigned long*>(d), reinterpret_cast<unsigned long const*>(s), n);
+#else
+	__asm__ volatile("rep movsl" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+#endif
+}
+
+void RepMovsqCopy(float* d, float const* s, std::size_t n)
+{
+	std::size_t qwords = n / 2;
+#ifdef _MSC_VER
+	__movsq(reinterpret_cast<unsigned __int64*>(d), reinterpret_cast<unsigned __int64 const*>(s), qwords);
+	d += 2 * qwords;
+	s += 2 * qwords;
+#else
+	__asm__ volatile("rep movsq" : "+D"(d), "+S"(s), "+c"(qwords) : : "memory");
+#endif
+	if(n % 2)
+		*d = *s;
+}
+
+// Whichever implementation the memcpy mode is measuring.
+void IndirectMemcpy(float* d, float const* s, std::size_t n)
+{
+	gMemcpy(d, s, n * sizeof(float));
+}
+
+void* PolicyMemcpy(void* d, void const* s, std::size_t bytes)
+{
+	copy(d, s, bytes, gCopyPolicy);
+	return d;
+}
+
+// One of the float kernels as a memcpy: whole floats through the
+// kernel, and any bytes past the last float through std::memcpy.
+template<void(*f)(float*, float const*, std::size_t)>
+void* KernelMemcpy(void* d, void const* s, std::size_t bytes)
+{
+	std::size_t const floats = bytes / sizeof(float);
+	f(static_cast<float*>(d), static_cast<float const*>(s), floats);
+	std::memcpy(static_cast<char*>(d) + floats * sizeof(float), static_cast<char const*>(s) + floats * sizeof(float), bytes % sizeof(float));
+	return d;
+}
+
+// Typed kernels for types mode. A copy does not look at its elements,
+// so the vector kernel moves whole vectors of bytes and only the tail
+// works in elements.
+template<typename E>
+void NiaveTypedCopy(typename E::type* d, typename E::type const* s, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = s[i];
+}
+
+template<typename E>
+SIMDPERF_TARGET("avx")
+void AvxTypedCopy(typename E::type* d, typename E::type const* s, std::size_t n)
+{
+	std::size_t const width = sizeof(__m256i) / sizeof(typename E::type);
+	std::size_t i = 0;
+	for(; i + width <= n; i += width)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&s[i]));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), v);
+	}
+
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
+
+// Strided and indexed kernels for stride mode. The strided kernels
+// read every gStride'th float. Gather reads s[index[i]] and scatter
+// writes d[index[i]], where index holds the strided offsets in a random
+// order, so all three touch the same lines.
+enum access_pattern
+{
+	kStrided,
+	kGather,
+	kScatter,
+};
+
+void NiaveStridedCopy(float* d, float const* s, std::int32_t const*, std::size_t n)
+{
+	std::size_t const stride = gStride;
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = s[i * stride];
+}
+
+SIMDPERF_TARGET("avx2")
+void Avx2StridedCopy(float* d, float const* s, std::int32_t const*, std::size_t n)
+{
+	std::size_t const stride = gStride;
+	__m256i const offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(int(stride)));
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(&d[i], _mm256_i32gather_ps(&s[i * stride], offsets, 4));
+
+	for(; i < n; ++i)
+		d[i] = s[i * stride];
+}
+
+SIMDPERF_TARGET("avx512f")
+void Avx512StridedCopy(float* d, float const* s, std::int32_t const*, std::size_t n)
+{
+	// The masked gathers, because GCC 12 warns about the undefined
+	// source of the plain ones.
+	std::size_t const stride = gStride;
+	__m512i const offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(int(stride)));
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+		_mm512_storeu_ps(&d[i], _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, offsets, &s[i * stride], 4));
+
+	for(; i < n; ++i)
+		d[i] = s[i * stride];
+}
+
+void NiaveGatherCopy(float* d, float const* s, std::int32_t const* index, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = s[index[i]];
+}
+
+SIMDPERF_TARGET("avx2")
+void Avx2GatherCopy(float* d, float const* s, std::int32_t const* index, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		__m256i offsets = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&index[i]));
+		_mm256_storeu_ps(&d[i], _mm256_i32gather_ps(s, offsets, 4));
+	}
+
+	for(; i < n; ++i)
+		d[i] = s[index[i]];
+}
+
+SIMDPERF_TARGET("avx512f")
+void Avx512GatherCopy(float* d, float const* s, std::int32_t const* index, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512i offsets = _mm512_loadu_si512(&index[i]);
+		_mm512_storeu_ps(&d[i], _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, offsets, s, 4));
+	}
+
+	for(; i < n; ++i)
+		d[i] = s[index[i]];
+}
+
+void NiaveScatterCopy(float* d, float const* s, std::int32_t const* index, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[index[i]] = s[i];
+}
+
+// AVX2 has gathers but no scatter.
+SIMDPERF_TARGET("avx512f")
+void Avx512ScatterCopy(float* d, float const* s, std::int32_t const* index, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512i offsets = _mm512_loadu_si512(&index[i]);
+		_mm512_i32scatter_ps(d, offsets, _mm512_loadu_ps(&s[i]), 4);
+	}
+
+	for(; i < n; ++i)
+		d[index[i]] = s[i];
+}
+
+// Lane mask with the first count lanes set, for maskload/maskstore.
+SIMDPERF_TARGET("avx")
+inline __m256i AvxTailMask(int count)
+{
+	static int const lanes[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+	return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&lanes[8 - count]));
+}
+
+SIMDPERF_TARGET("sse2")
+void UnalignedSseCopy(float* d, float const* s, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 4)
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
 	{
 		__m128 v = _mm_loadu_ps(&s[i]);
 		_mm_storeu_ps(&d[i], v);
 	}
+
+	for(; i < n; ++i)
+		d[i] = s[i];
 }
 
-void AlignedSseCopy(float* d, float const* s)
+SIMDPERF_TARGET("sse2")
+void AlignedSseCopy(float* d, float const* s, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 4)
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
 	{
 		__m128 v = _mm_load_ps(&s[i]);
 		_mm_store_ps(&d[i], v);
 	}
+
+	for(; i < n; ++i)
+		d[i] = s[i];
 }
 
-void AlignedSseNonTemporalCopy(float* d, float const* s)
+SIMDPERF_TARGET("sse2")
+void AlignedSseNonTemporalCopy(float* d, float const* s, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 4)
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
 	{
 		__m128 v = _mm_load_ps(&s[i]);
 		_mm_stream_ps(&d[i], v);
 	}
+
+	// Streaming stores are weakly ordered; fence them so they are
+	// globally visible before anything after the kernel.
+	_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = s[i];
 }
 
-#if SUPPORT_AVX
-void UnalignedAvxCopy(float* d, float const* s)
+SIMDPERF_TARGET("avx")
+void UnalignedAvxCopy(float* d, float const* s, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 8)
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
 		__m256 v = _mm256_loadu_ps(&s[i]);
 		_mm256_storeu_ps(&d[i], v);
 	}
+
+	for(; i < n; ++i)
+		d[i] = s[i];
 }
 
-void AlignedAvxCopy(float* d, float const* s)
+SIMDPERF_TARGET("avx")
+void AlignedAvxCopy(float* d, float const* s, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 8)
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
 		__m256 v = _mm256_load_ps(&s[i]);
 		_mm256_store_ps(&d[i], v);
 	}
+
+	for(; i < n; ++i)
+		d[i] = s[i];
 }
 
-void AlignedAvxNonTemporalCopy(float* d, float const* s)
+SIMDPERF_TARGET("avx")
+void AlignedAvxNonTemporalCopy(float* d, float const* s, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 8)
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
 		__m256 v = _mm256_load_ps(&s[i]);
 		_mm256_stream_ps(&d[i], v);
 	}
+
+	_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = s[i];
 }
-#endif
 
-void NullCopy(float* d, float const* s)
-{}
+SIMDPERF_TARGET("avx512f")
+void UnalignedAvx512Copy(float* d, float const* s, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512 v = _mm512_loadu_ps(&s[i]);
+		_mm512_storeu_ps(&d[i], v);
+	}
+
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
 
-// ----------------------------------------------------------------------------
-//
-template<void(*f)(float*, float const*)>
-void Run(char const* name, std::size_t alignment, float* d, float const* s)
+SIMDPERF_TARGET("avx512f")
+void AlignedAvx512Copy(float* d, float const* s, std::size_t n)
 {
-	d = align(d, alignment);
-	s = align(s, alignment);
-	std::fill(d, d + gNumFloats, 0.f);
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512 v = _mm512_load_ps(&s[i]);
+		_mm512_store_ps(&d[i], v);
+	}
+
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
 
-	cgutil::timer t;
-	for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+SIMDPERF_TARGET("avx512f")
+void AlignedAvx512NonTemporalCopy(float* d, float const* s, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
 	{
-		f(d, s);
+		__m512 v = _mm512_load_ps(&s[i]);
+		_mm512_stream_ps(&d[i], v);
 	}
-	float time = t.elapsed();
 
-	for(std::size_t i = 0; i < gNumFloats; ++i)
+	_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
+
+// Full vectors, then one masked vector for whatever is left.
+SIMDPERF_TARGET("avx512f")
+void MaskedAvx512Copy(float* d, float const* s, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
 	{
-		if(d[i] != s[i])
-		{
-			std::cerr << "Error in " << name << " " << d[i] << " != " << s[i] << std::endl;
-			std::exit(1);
-		}
+		__m512 v = _mm512_loadu_ps(&s[i]);
+		_mm512_storeu_ps(&d[i], v);
 	}
 
-	std::cerr << name 
-			  << " (" << alignment << ") took " 
-			  << time << " seconds." 
-			  << std::endl
-	;
+	__mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+	__m512 v = _mm512_maskz_loadu_ps(tail, &s[i]);
+	_mm512_mask_storeu_ps(&d[i], tail, v);
+}
 
-	std::cout << "," << time;
+// One plain loop compiled twice for AVX-512 hardware, with the
+// vectorizer preferring 512 or 256 bit vectors, to weigh the 512 bit
+// clock penalty against narrower code. SIMDPERF_VECTORIZE has them
+// vectorized at -O2 as well as -O3.
+SIMDPERF_TARGET("avx512f,avx512vl,prefer-vector-width=512")
+SIMDPERF_NO_MEMCPY_IDIOM
+SIMDPERF_VECTORIZE
+void Vectorized512Copy(float* d, float const* s, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = s[i];
 }
 
-template<>
-void Run<NullCopy>(char const* name, std::size_t alignment, float* d, float const* s)
+SIMDPERF_TARGET("avx512f,avx512vl,prefer-vector-width=256")
+SIMDPERF_NO_MEMCPY_IDIOM
+SIMDPERF_VECTORIZE
+void Vectorized256Copy(float* d, float const* s, std::size_t n)
 {
-	std::cout << "," << 0;
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = s[i];
 }
 
+// Tail strategies. The kernels above finish with a scalar epilogue;
+// these finish with one overlapping full vector ending at the last
+// element, or with an AVX maskload/maskstore pair.
+SIMDPERF_TARGET("sse2")
+void UnalignedSseOverlapCopy(float* d, float const* s, std::size_t n)
+{
+	if(n < 4)
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			d[i] = s[i];
+		return;
+	}
 
-// ----------------------------------------------------------------------------
-//
-void print_usage()
+	for(std::size_t i = 0; i + 4 <= n; i += 4)
+	{
+		__m128 v = _mm_loadu_ps(&s[i]);
+		_mm_storeu_ps(&d[i], v);
+	}
+
+	__m128 v = _mm_loadu_ps(&s[n - 4]);
+	_mm_storeu_ps(&d[n - 4], v);
+}
+
+SIMDPERF_TARGET("avx")
+void UnalignedAvxOverlapCopy(float* d, float const* s, std::size_t n)
 {
-	std::cerr << "Usage:\n" 
-			  << "copy [options]\n"
-			  << "num-floats=<number of float in memory>    default (" << kDefaultNumFloats << ")\n"
-			  << "total-floats=<number of floats total>     default (" << kDefaultTotalFloats << ")\n"
-			  << "check-value=<any value to check against>  default (" << gCheckValue << ")\n"
-			  << "enable-avx=<true/false>                   default (" << std::boolalpha << gHasAvx << ")\n"
-			  << "report-html=<true/false>                  default (" << std::boolalpha << gHtmlOut << ")\n"
-			  << std::endl;
+	if(n < 8)
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			d[i] = s[i];
+		return;
+	}
+
+	for(std::size_t i = 0; i + 8 <= n; i += 8)
+	{
+		__m256 v = _mm256_loadu_ps(&s[i]);
+		_mm256_storeu_ps(&d[i], v);
+	}
 
+	__m256 v = _mm256_loadu_ps(&s[n - 8]);
+	_mm256_storeu_ps(&d[n - 8], v);
 }
 
-// ----------------------------------------------------------------------------
-//
-int main(int argc, char** argv)
+SIMDPERF_TARGET("avx")
+void UnalignedAvxMaskedCopy(float* d, float const* s, std::size_t n)
 {
-	cgutil::program_options opts;
-	opts.add("num-floats", gNumFloats);
-	opts.add("num-floats", gNumFloats);
-	opts.add("total-floats", gTotalFloats);
-	opts.add("check-value", gCheckValue);
-	opts.add("enable-avx", gHasAvx);
-	
-	try
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
-		opts.parse(argc, argv);
+		__m256 v = _mm256_loadu_ps(&s[i]);
+		_mm256_storeu_ps(&d[i], v);
 	}
-	catch(std::runtime_error e)
+
+	__m256i tail = AvxTailMask(int(n - i));
+	__m256 v = _mm256_maskload_ps(&s[i], tail);
+	_mm256_maskstore_ps(&d[i], tail, v);
+}
+
+// Prefetching variants. Unrolled to one cache line per iteration with
+// one prefetch per line, gPrefetchDistance bytes ahead of the loads,
+// or of the stores for prefetchw.
+template<int hint>
+SIMDPERF_TARGET("sse2")
+void PrefetchSseCopy(float* d, float const* s, std::size_t n)
+{
+	std::size_t const ahead = gPrefetchDistance / sizeof(float);
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
 	{
-		std::cerr << e.what() << std::endl;
-		print_usage();
-		std::exit(1);
+		prefetch<hint>(hint == kPrefetchW ? &d[i + ahead] : &s[i + ahead]);
+		__m128 v0 = _mm_loadu_ps(&s[i]);
+		__m128 v1 = _mm_loadu_ps(&s[i + 4]);
+		__m128 v2 = _mm_loadu_ps(&s[i + 8]);
+		__m128 v3 = _mm_loadu_ps(&s[i + 12]);
+		_mm_storeu_ps(&d[i], v0);
+		_mm_storeu_ps(&d[i + 4], v1);
+		_mm_storeu_ps(&d[i + 8], v2);
+		_mm_storeu_ps(&d[i + 12], v3);
 	}
 
-	if(gTotalFloats < gNumFloats)
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
+
+template<int hint>
+SIMDPERF_TARGET("avx")
+void PrefetchAvxCopy(float* d, float const* s, std::size_t n)
+{
+	std::size_t const ahead = gPrefetchDistance / sizeof(float);
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
 	{
-		std::cerr << "total-floats must be greater than num-floats" << std::endl;
-		print_usage();
-		return 0;
+		prefetch<hint>(hint == kPrefetchW ? &d[i + ahead] : &s[i + ahead]);
+		__m256 v0 = _mm256_loadu_ps(&s[i]);
+		__m256 v1 = _mm256_loadu_ps(&s[i + 8]);
+		_mm256_storeu_ps(&d[i], v0);
+		_mm256_storeu_ps(&d[i + 8], v1);
 	}
 
-	if(gHtmlOut)
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
+
+// Generated kernels: unroll vectors per iteration held in independent
+// registers, loaded and stored with the given memory_flavor. A target
+// attribute cannot depend on a template argument, so each ISA has its
+// own copy of the loop around the shared vector ops.
+template<int unroll, int flavor>
+SIMDPERF_TARGET("sse2")
+void UnrolledSseCopy(float* d, float const* s, std::size_t n)
+{
+	typedef sse_ops V;
+	std::size_t const step = V::width * unroll;
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
 	{
-		std::cout <<
-		   "<html>\n"
-		   "  <head>\n"
-		   "    <script type=\"text/javascript\" src=\"https://www.google.com/jsapi\"></script>\n"
-		   "    <script type=\"text/javascript\">\n"
-		   "      google.load(\"visualization\", \"1\", {packages:[\"corechart\"]});\n"
-		   "      google.setOnLoadCallback(drawChart);\n"
-		   "      function drawChart() {\n"
-		   "        var data = google.visualization.arrayToDataTable([\n"
-		;
+		V::type v[unroll];
+		for(int u = 0; u < unroll; ++u)
+			v[u] = V::load<flavor>(&s[i + u * V::width]);
+
+		for(int u = 0; u < unroll; ++u)
+			V::store<flavor>(&d[i + u * V::width], v[u]);
 	}
 
-	// Allocate 64 megs worth of floats;
-	std::vector<float> source(gNumFloats + 0x100, gCheckValue);
-	std::vector<float> dest(gNumFloats + 0x100, 0.f);
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
 
-	std::cout << "[\'Alignment\',\'std::memcpy\',\'std::copy\',\'for-loop\',\'Unaligned Sse\',\'Unaligned Avx\',\'Aligned Sse\',\'Aligned Sse Stream\',\'Aligned Avx\',\'Aligned Avx Stream\'";
-	for(std::size_t alignment = 4; alignment <= 64; ++alignment)
+template<int unroll, int flavor>
+SIMDPERF_TARGET("avx")
+void UnrolledAvxCopy(float* d, float const* s, std::size_t n)
+{
+	typedef avx_ops V;
+	std::size_t const step = V::width * unroll;
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
 	{
-		std::cout << "],\n" << "[" << alignment;
+		V::type v[unroll];
+		for(int u = 0; u < unroll; ++u)
+			v[u] = V::load<flavor>(&s[i + u * V::width]);
 
-		Run<MemCopy>("std::memcpy", alignment, dest.data(), source.data());
-		Run<StdCopy>("std::copy", alignment, dest.data(), source.data());
-		Run<SimpleCopy>("for-loop", alignment, dest.data(), source.data());
-		Run<UnalignedSseCopy>("Unaligned Sse", alignment, dest.data(), source.data());
+		for(int u = 0; u < unroll; ++u)
+			V::store<flavor>(&d[i + u * V::width], v[u]);
+	}
 
-	#if SUPPORT_AVX
-		if(gHasAvx)
-		{
-			Run<UnalignedAvxCopy>("Unaligned Avx", alignment, dest.data(), source.data());
-		}
-		else
-	#endif
-		{
-			Run<NullCopy>("Unaligned Avx", alignment, source.data(), source.data());
-		}
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
 
-		if(alignment % 16 == 0)
+template<int unroll, int flavor>
+SIMDPERF_TARGET("avx512f")
+void UnrolledAvx512Copy(float* d, float const* s, std::size_t n)
+{
+	typedef avx512_ops V;
+	std::size_t const step = V::width * unroll;
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
+	{
+		V::type v[unroll];
+		for(int u = 0; u < unroll; ++u)
+			v[u] = V::load<flavor>(&s[i + u * V::width]);
+
+		for(int u = 0; u < unroll; ++u)
+			V::store<flavor>(&d[i + u * V::width], v[u]);
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = s[i];
+}
+
+// ----------------------------------------------------------------------------
+//
+double CyclesPerFloat(trial_stats const& stats)
+{
+	return seconds_to_cycles(stats.median) / gTotalFloats;
+}
+
+double GigabytesPerSecond(trial_stats const& stats)
+{
+	if(stats.median <= 0)
+		return 0;
+
+	return double(kStreamsPerFloat) * sizeof(float) * gTotalFloats / stats.median / 1e9;
+}
+
+double ChartValue(trial_stats const& stats)
+{
+	return gReportCycles ? CyclesPerFloat(stats) : stats.median;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Checks the kernel output and that nothing was written into the guard
+// floats past the end.
+void CheckResult(char const* name, float const* d, float const* s)
+{
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		if(d[i] != s[i])
 		{
-			Run<AlignedSseCopy>("Aligned Sse", alignment, dest.data(), source.data());
-			Run<AlignedSseNonTemporalCopy>("Aligned Sse Stream", alignment, dest.data(), source.data());
+			std::cerr << "Error in " << name << " " << d[i] << " != " << s[i] << std::endl;
+			std::exit(1);
 		}
-		else
+	}
+
+	for(std::size_t i = gNumFloats; i < gNumFloats + kGuardFloats; ++i)
+	{
+		if(d[i] != 0.f)
 		{
-			Run<NullCopy>("Aligned Sse", alignment, source.data(), source.data());
-			Run<NullCopy>("Aligned Sse Stream", alignment, source.data(), source.data());
+			std::cerr << "Error in " << name << " wrote past the end at " << i << std::endl;
+			std::exit(1);
 		}
-	#if SUPPORT_AVX
-		if(alignment % 32 == 0 && gHasAvx)
+	}
+}
+
+template<void(*f)(float*, float const*, std::size_t)>
+trial_stats Run(char const* name, placement const& dp, placement const& sp, float* d, float const* s)
+{
+	d = place(d, dp);
+	s = place(s, sp);
+	std::fill(d, d + gNumFloats + kGuardFloats, 0.f);
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
 		{
-			Run<AlignedAvxCopy>("Aligned Avx", alignment, dest.data(), source.data());
-			Run<AlignedAvxNonTemporalCopy>("Aligned Avx Stream", alignment, dest.data(), source.data());
+			f(d, s, gNumFloats);
 		}
-		else
-	#endif
-		{
-			Run<NullCopy>("Aligned Avx", alignment, source.data(), source.data());
-			Run<NullCopy>("Aligned Avx Stream", alignment, source.data(), source.data());
-		}       
-	}
+	};
 
-	std::cout << "]" << std::endl;
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
 
-	if(gHtmlOut)
+	CheckResult(name, d, s);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_float = CyclesPerFloat(stats);
+	double bytes_per_cycle = kStreamsPerFloat * sizeof(float) / cycles_per_float;
+	std::cerr << name 
+			  << " (dst " << dp << ", src " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/float " << cycles_per_float
+			  << " bytes/cycle " << bytes_per_cycle
+			  << std::endl
+	;
+
+	if(gCounters.available())
 	{
-		std::cout <<
-			"        ]);\n"
-			"        var options = {\n"
-			"          title: 'Alignment vs. Run Time'\n"
-			"        };\n"
-			"        var chart = new google.visualization.LineChart(document.getElementById('chart_div'));\n"
-			"        chart.draw(data, options);\n"
-			"      }\n"
-			"    </script>\n"
-			"  </head>\n"
-			"  <body>\n"
-			"    <div id=\"chart_div\" style=\"width: 900px; height: 500px;\"></div>\n"
-			"  </body>\n"
-			"</html>\n"
-		;
+		cgutil::timer t;
+		perf_sample counted = gCounters.count(pass);
+		double seconds = t.elapsed();
+		std::cerr << "    ";
+		print_perf_sample(std::cerr, counted, double(kStreamsPerFloat) * sizeof(float) * gTotalFloats, seconds);
+		std::cerr << std::endl;
 	}
 
+	return stats;
+}
+
+// Runs f with the buffers split across every member of team, each member
+// working its own chunk as many times as Run would work the whole
+// buffer, so the stats are comparable with Run.
+template<void(*f)(float*, float const*, std::size_t)>
+trial_stats RunParallel(char const* name, thread_team& team, placement const& dp, placement const& sp, float* d, float const* s)
+{
+	d = place(d, dp);
+	s = place(s, sp);
+	std::fill(d, d + gNumFloats + kGuardFloats, 0.f);
+
+	// Chunks start on cache lines so the aligned kernels stay aligned and
+	// no two members share a line.
+	std::size_t const granule = kCacheLineBytes / sizeof(float);
+	std::function<void(std::size_t)> job = [&](std::size_t index)
+	{
+		std::size_t begin, end;
+		partition(gNumFloats, team.size(), granule, index, begin, end);
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			f(d + begin, s + begin, end - begin);
+		}
+	};
+
+	auto pass = [&]
+	{
+		team.run(job);
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+	CheckResult(name, d, s);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	std::cerr << name 
+			  << " (" << team.size() << " threads, dst " << dp << ", src " << sp << ") seconds: " 
+			  << stats
+			  << " GB/s " << GigabytesPerSecond(stats)
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Setup and kernel time for single passes into a fresh destination.
+struct cold_stats
+{
+	trial_stats setup;
+	trial_stats run;
+};
+
+// Runs f once per trial into a destination mapped just before it, so
+// the kernel takes every page fault unless policy already took them in
+// the setup: the mmap plus any populate or prefault work. Unmapping the
+// previous trial's destination is not timed.
+template<void(*f)(float*, float const*, std::size_t)>
+cold_stats RunCold(char const* name, fault_policy policy, thread_team& team, placement const& dp, placement const& sp, float const* s)
+{
+	s = place(s, sp);
+	std::size_t const bytes = (gNumFloats + placement_padding(dp) / sizeof(float)) * sizeof(float);
+	std::unique_ptr<page_buffer> pages;
+	float* d = nullptr;
+
+	std::function<void(std::size_t)> prefault = [&](std::size_t index)
+	{
+		std::size_t const page_bytes = page_kind_bytes(pages->kind());
+		std::size_t begin, end;
+		partition(pages->size(), team.size(), page_bytes, index, begin, end);
+		touch_pages(pages->data<char>() + begin, end - begin, page_bytes);
+	};
+
+	auto setup = [&]
+	{
+		pages.reset(new page_buffer(bytes, gPageKind, policy == fault_policy::populate));
+		if(!pages->data<float>())
+			return;
+
+		if(policy == fault_policy::prefault)
+			team.run(prefault);
+		else if(policy == fault_policy::warm)
+			touch_pages(pages->data<float>(), pages->size(), page_kind_bytes(pages->kind()));
+	};
+
+	auto pass = [&]
+	{
+		f(d, s, gNumFloats);
+	};
+
+	std::vector<double> setup_samples;
+	std::vector<double> run_samples;
+	for(std::size_t i = 0; i < gWarmupTrials + gTrials; ++i)
+	{
+		double setup_seconds = 0;
+		if(!pages || policy != fault_policy::warm)
+		{
+			pages.reset();
+			setup_seconds = time_call(gTimingBackend, setup);
+			if(!pages->data<float>())
+			{
+				std::cerr << "failed to map " << format_bytes(bytes) << " of " << page_kind_name(gPageKind) << " pages" << std::endl;
+				std::exit(1);
+			}
+
+			d = place(pages->data<float>(), dp);
+		}
+
+		// A warm destination is only set up once, so it has no setup
+		// cost per pass.
+		if(policy == fault_policy::warm)
+			setup_seconds = 0;
+
+		double run_seconds = time_call(gTimingBackend, pass);
+		if(i >= gWarmupTrials)
+		{
+			setup_samples.push_back(setup_seconds);
+			run_samples.push_back(run_seconds);
+		}
+	}
+
+	CheckResult(name, d, s);
+
+	cold_stats stats;
+	stats.setup = summarise(setup_samples, gBootstrapResamples, gConfidence);
+	stats.run = summarise(run_samples, gBootstrapResamples, gConfidence);
+	std::cerr << name << " (" << fault_policy_name(policy) << ", dst " << dp << ", src " << sp << ")"
+			  << " setup seconds: " << stats.setup.median
+			  << " run seconds: " << stats.run
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Checks a typed kernel's copy and that nothing was written into the
+// guard elements.
+template<typename E>
+void CheckTypedResult(char const* name, typename E::type const* d, typename E::type const* s, std::size_t n, std::size_t guard)
+{
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		if(d[i] != s[i])
+		{
+			std::cerr << "Error in " << name << " " << E::to_double(d[i]) << " != " << E::to_double(s[i]) << std::endl;
+			std::exit(1);
+		}
+	}
+
+	for(std::size_t i = n; i < n + guard; ++i)
+	{
+		if(d[i] != 0)
+		{
+			std::cerr << "Error in " << name << " wrote past the end at " << i << std::endl;
+			std::exit(1);
+		}
+	}
+}
+
+// Run for the typed kernels. num-floats and total-floats are taken as
+// byte counts in floats, so every element type moves the same bytes
+// and GigabytesPerSecond applies unchanged. The source is filled with
+// check-value plus the element's position converted to the element
+// type, so a kernel that reorders lanes fails validation.
+template<typename E, void(*f)(typename E::type*, typename E::type const*, std::size_t)>
+trial_stats RunTyped(char const* name, placement const& dp, placement const& sp, void* d_memory, void* s_memory)
+{
+	typedef typename E::type T;
+	std::size_t const n = gNumFloats * sizeof(float) / sizeof(T);
+	std::size_t const total = gTotalFloats * sizeof(float) / sizeof(T);
+	std::size_t const guard = kCacheLineBytes / sizeof(T);
+	T* d = place(static_cast<T*>(d_memory), dp);
+	T* s = place(static_cast<T*>(s_memory), sp);
+	for(std::size_t i = 0; i < n; ++i)
+		s[i] = E::from_float(gCheckValue + float(i & 0xff));
+	std::fill(d, d + n + guard, T(0));
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < total; i += n)
+		{
+			f(d, s, n);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	CheckTypedResult<E>(name, d, s, n, guard);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_element = seconds_to_cycles(stats.median) / total;
+	std::cerr << name 
+			  << " (dst " << dp << ", src " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/element " << cycles_per_element
+			  << " bytes/cycle " << kStreamsPerFloat * sizeof(T) / cycles_per_element
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Checks every element a strided or indexed kernel wrote, and that it
+// wrote nothing else up to the guard floats past the furthest element
+// it may write.
+void CheckIndexedResult(char const* name, int pattern, float const* d, float const* s, std::int32_t const* index)
+{
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		float const expected = pattern == kStrided ? s[i * gStride] : pattern == kGather ? s[index[i]] : s[i];
+		float const actual = pattern == kScatter ? d[index[i]] : d[i];
+		if(actual != expected)
+		{
+			std::cerr << "Error in " << name << " " << actual << " != " << expected << std::endl;
+			std::exit(1);
+		}
+	}
+
+	std::size_t const span = gNumFloats * gStride;
+	std::size_t const written = pattern == kScatter ? span : gNumFloats;
+	for(std::size_t j = 0; j < written + kGuardFloats; ++j)
+	{
+		bool const target = pattern == kScatter ? j < span && j % gStride == 0 : j < gNumFloats;
+		if(!target && d[j] != 0.f)
+		{
+			std::cerr << "Error in " << name << " wrote outside its elements at " << j << std::endl;
+			std::exit(1);
+		}
+	}
+}
+
+// Run for the stride mode kernels. Bytes and cycles count only the
+// floats the kernel uses, not the lines it has to move to get them.
+template<int pattern, void(*f)(float*, float const*, std::int32_t const*, std::size_t)>
+trial_stats RunIndexed(char const* name, placement const& dp, placement const& sp, float* d, float const* s, std::int32_t const* index)
+{
+	d = place(d, dp);
+	s = place(s, sp);
+	std::fill(d, d + (pattern == kScatter ? gNumFloats * gStride : gNumFloats) + kGuardFloats, 0.f);
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			f(d, s, index, gNumFloats);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	CheckIndexedResult(name, pattern, d, s, index);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_float = CyclesPerFloat(stats);
+	std::cerr << name 
+			  << " (stride " << gStride << ", dst " << dp << ", src " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/float " << cycles_per_float
+			  << " bytes/cycle " << kStreamsPerFloat * sizeof(float) / cycles_per_float
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// ----------------------------------------------------------------------------
+//
+typedef trial_stats (*RunFn)(char const*, placement const&, placement const&, float*, float const*);
+typedef trial_stats (*RunParallelFn)(char const*, thread_team&, placement const&, placement const&, float*, float const*);
+typedef cold_stats (*RunColdFn)(char const*, fault_policy, thread_team&, placement const&, placement const&, float const*);
+typedef trial_stats (*RunTypedFn)(char const*, placement const&, placement const&, void*, void*);
+typedef trial_stats (*RunIndexedFn)(char const*, placement const&, placement const&, float*, float const*, std::int32_t const*);
+
+struct Kernel
+{
+	char const* name;
+	RunFn run;
+	RunParallelFn run_parallel;
+	RunColdFn run_cold;
+	std::size_t alignment; // required, in bytes
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+Kernel const kKernels[] =
+{
+	{ "std::memcpy",           &Run<MemCopy>,                      &RunParallel<MemCopy>,                      &RunCold<MemCopy>,                      1,  0                          },
+	{ "std::copy",             &Run<StdCopy>,                      &RunParallel<StdCopy>,                      &RunCold<StdCopy>,                      1,  0                          },
+	{ "rep movsb",             &Run<RepMovsbCopy>,                 &RunParallel<RepMovsbCopy>,                 &RunCold<RepMovsbCopy>,                 1,  0                          },
+	{ "rep movsd",             &Run<RepMovsdCopy>,                 &RunParallel<RepMovsdCopy>,                 &RunCold<RepMovsdCopy>,                 1,  0                          },
+	{ "rep movsq",             &Run<RepMovsqCopy>,                 &RunParallel<RepMovsqCopy>,                 &RunCold<RepMovsqCopy>,                 1,  0                          },
+	{ "for-loop",              &Run<SimpleCopy>,                   &RunParallel<SimpleCopy>,                   &RunCold<SimpleCopy>,                   1,  0                          },
+	{ "Unaligned Sse",         &Run<UnalignedSseCopy>,             &RunParallel<UnalignedSseCopy>,             &RunCold<UnalignedSseCopy>,             1,  kCpuSse2                   },
+	{ "Unaligned Avx",         &Run<UnalignedAvxCopy>,             &RunParallel<UnalignedAvxCopy>,             &RunCold<UnalignedAvxCopy>,             1,  kCpuAvx                    },
+	{ "Aligned Sse",           &Run<AlignedSseCopy>,               &RunParallel<AlignedSseCopy>,               &RunCold<AlignedSseCopy>,               16, kCpuSse2                   },
+	{ "Aligned Sse Stream",    &Run<AlignedSseNonTemporalCopy>,    &RunParallel<AlignedSseNonTemporalCopy>,    &RunCold<AlignedSseNonTemporalCopy>,    16, kCpuSse2                   },
+	{ "Aligned Avx",           &Run<AlignedAvxCopy>,               &RunParallel<AlignedAvxCopy>,               &RunCold<AlignedAvxCopy>,               32, kCpuAvx                    },
+	{ "Aligned Avx Stream",    &Run<AlignedAvxNonTemporalCopy>,    &RunParallel<AlignedAvxNonTemporalCopy>,    &RunCold<AlignedAvxNonTemporalCopy>,    32, kCpuAvx                    },
+	{ "Unaligned Avx512",      &Run<UnalignedAvx512Copy>,          &RunParallel<UnalignedAvx512Copy>,          &RunCold<UnalignedAvx512Copy>,          1,  kCpuAvx512f                },
+	{ "Aligned Avx512",        &Run<AlignedAvx512Copy>,            &RunParallel<AlignedAvx512Copy>,            &RunCold<AlignedAvx512Copy>,            64, kCpuAvx512f                },
+	{ "Aligned Avx512 Stream", &Run<AlignedAvx512NonTemporalCopy>, &RunParallel<AlignedAvx512NonTemporalCopy>, &RunCold<AlignedAvx512NonTemporalCopy>, 64, kCpuAvx512f                },
+	{ "Masked Avx512",         &Run<MaskedAvx512Copy>,             &RunParallel<MaskedAvx512Copy>,             &RunCold<MaskedAvx512Copy>,             1,  kCpuAvx512f                },
+	{ "Vectorized Avx512 512", &Run<Vectorized512Copy>,            &RunParallel<Vectorized512Copy>,            &RunCold<Vectorized512Copy>,            1,  kCpuAvx512f | kCpuAvx512vl },
+	{ "Vectorized Avx512 256", &Run<Vectorized256Copy>,            &RunParallel<Vectorized256Copy>,            &RunCold<Vectorized256Copy>,            1,  kCpuAvx512f | kCpuAvx512vl },
+	{ "Unaligned Sse Overlap", &Run<UnalignedSseOverlapCopy>,      &RunParallel<UnalignedSseOverlapCopy>,      &RunCold<UnalignedSseOverlapCopy>,      1,  kCpuSse2                   },
+	{ "Unaligned Avx Overlap", &Run<UnalignedAvxOverlapCopy>,      &RunParallel<UnalignedAvxOverlapCopy>,      &RunCold<UnalignedAvxOverlapCopy>,      1,  kCpuAvx                    },
+	{ "Unaligned Avx Masked",  &Run<UnalignedAvxMaskedCopy>,       &RunParallel<UnalignedAvxMaskedCopy>,       &RunCold<UnalignedAvxMaskedCopy>,       1,  kCpuAvx                    },
+	{ "Unaligned Sse Stream",  &Run<UnalignedSseNonTemporalCopy>,  &RunParallel<UnalignedSseNonTemporalCopy>,  &RunCold<UnalignedSseNonTemporalCopy>,  1,  kCpuSse2                   },
+	{ "Unaligned Avx Stream",  &Run<UnalignedAvxNonTemporalCopy>,  &RunParallel<UnalignedAvxNonTemporalCopy>,  &RunCold<UnalignedAvxNonTemporalCopy>,  1,  kCpuAvx                    },
+	{ "copy() policy",         &Run<PolicyCopy>,                   &RunParallel<PolicyCopy>,                   &RunCold<PolicyCopy>,                   1,  0                          },
+};
+
+// The prefetching variants only run in prefetch mode, each against the
+// same loop instantiated without prefetches.
+struct PrefetchKernel
+{
+	char const* name;
+	RunFn run;
+	RunFn baseline;
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+PrefetchKernel const kPrefetchKernels[] =
+{
+	{ "Prefetch Sse T0",  &Run<PrefetchSseCopy<kPrefetchT0>>,  &Run<PrefetchSseCopy<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse T1",  &Run<PrefetchSseCopy<kPrefetchT1>>,  &Run<PrefetchSseCopy<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse T2",  &Run<PrefetchSseCopy<kPrefetchT2>>,  &Run<PrefetchSseCopy<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse NTA", &Run<PrefetchSseCopy<kPrefetchNta>>, &Run<PrefetchSseCopy<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse W",   &Run<PrefetchSseCopy<kPrefetchW>>,   &Run<PrefetchSseCopy<kPrefetchNone>>, kCpuSse2 | kCpuPrfchw },
+	{ "Prefetch Avx T0",  &Run<PrefetchAvxCopy<kPrefetchT0>>,  &Run<PrefetchAvxCopy<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx T1",  &Run<PrefetchAvxCopy<kPrefetchT1>>,  &Run<PrefetchAvxCopy<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx T2",  &Run<PrefetchAvxCopy<kPrefetchT2>>,  &Run<PrefetchAvxCopy<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx NTA", &Run<PrefetchAvxCopy<kPrefetchNta>>, &Run<PrefetchAvxCopy<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx W",   &Run<PrefetchAvxCopy<kPrefetchW>>,   &Run<PrefetchAvxCopy<kPrefetchNone>>, kCpuAvx | kCpuPrfchw  },
+};
+
+// Generated kernels for the unroll sweep. Each family is one ISA and
+// memory flavor at every unroll depth.
+struct UnrolledKernel
+{
+	char const* family;
+	int unroll;
+	RunFn run;
+	std::size_t alignment; // required, in bytes
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+UnrolledKernel const kUnrolledKernels[] =
+{
+	{ "Sse Unaligned",    1, &Run<UnrolledSseCopy<1, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Unaligned",    2, &Run<UnrolledSseCopy<2, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Unaligned",    4, &Run<UnrolledSseCopy<4, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Unaligned",    8, &Run<UnrolledSseCopy<8, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Aligned",      1, &Run<UnrolledSseCopy<1, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Aligned",      2, &Run<UnrolledSseCopy<2, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Aligned",      4, &Run<UnrolledSseCopy<4, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Aligned",      8, &Run<UnrolledSseCopy<8, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Stream",       1, &Run<UnrolledSseCopy<1, kStream>>,       16, kCpuSse2    },
+	{ "Sse Stream",       2, &Run<UnrolledSseCopy<2, kStream>>,       16, kCpuSse2    },
+	{ "Sse Stream",       4, &Run<UnrolledSseCopy<4, kStream>>,       16, kCpuSse2    },
+	{ "Sse Stream",       8, &Run<UnrolledSseCopy<8, kStream>>,       16, kCpuSse2    },
+	{ "Avx Unaligned",    1, &Run<UnrolledAvxCopy<1, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Unaligned",    2, &Run<UnrolledAvxCopy<2, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Unaligned",    4, &Run<UnrolledAvxCopy<4, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Unaligned",    8, &Run<UnrolledAvxCopy<8, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Aligned",      1, &Run<UnrolledAvxCopy<1, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Aligned",      2, &Run<UnrolledAvxCopy<2, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Aligned",      4, &Run<UnrolledAvxCopy<4, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Aligned",      8, &Run<UnrolledAvxCopy<8, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Stream",       1, &Run<UnrolledAvxCopy<1, kStream>>,       32, kCpuAvx     },
+	{ "Avx Stream",       2, &Run<UnrolledAvxCopy<2, kStream>>,       32, kCpuAvx     },
+	{ "Avx Stream",       4, &Run<UnrolledAvxCopy<4, kStream>>,       32, kCpuAvx     },
+	{ "Avx Stream",       8, &Run<UnrolledAvxCopy<8, kStream>>,       32, kCpuAvx     },
+	{ "Avx512 Unaligned", 1, &Run<UnrolledAvx512Copy<1, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Unaligned", 2, &Run<UnrolledAvx512Copy<2, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Unaligned", 4, &Run<UnrolledAvx512Copy<4, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Unaligned", 8, &Run<UnrolledAvx512Copy<8, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Aligned",   1, &Run<UnrolledAvx512Copy<1, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Aligned",   2, &Run<UnrolledAvx512Copy<2, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Aligned",   4, &Run<UnrolledAvx512Copy<4, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Aligned",   8, &Run<UnrolledAvx512Copy<8, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Stream",    1, &Run<UnrolledAvx512Copy<1, kStream>>,    64, kCpuAvx512f },
+	{ "Avx512 Stream",    2, &Run<UnrolledAvx512Copy<2, kStream>>,    64, kCpuAvx512f },
+	{ "Avx512 Stream",    4, &Run<UnrolledAvx512Copy<4, kStream>>,    64, kCpuAvx512f },
+	{ "Avx512 Stream",    8, &Run<UnrolledAvx512Copy<8, kStream>>,    64, kCpuAvx512f },
+};
+
+// Kernels for types mode: a for-loop and a vector kernel per element
+// type. Half needs F16C only to convert check-value.
+struct TypedKernel
+{
+	char const* name;
+	char const* type;
+	RunTypedFn run;
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+TypedKernel const kTypedKernels[] =
+{
+	{ "for-loop", "float",  &RunTyped<f32_element, NiaveTypedCopy<f32_element>>, 0                  },
+	{ "for-loop", "double", &RunTyped<f64_element, NiaveTypedCopy<f64_element>>, 0                  },
+	{ "for-loop", "int32",  &RunTyped<i32_element, NiaveTypedCopy<i32_element>>, 0                  },
+	{ "for-loop", "int16",  &RunTyped<i16_element, NiaveTypedCopy<i16_element>>, 0                  },
+	{ "for-loop", "int8",   &RunTyped<i8_element, NiaveTypedCopy<i8_element>>,   0                  },
+	{ "for-loop", "half",   &RunTyped<f16_element, NiaveTypedCopy<f16_element>>, kCpuF16c           },
+	{ "Avx",      "float",  &RunTyped<f32_element, AvxTypedCopy<f32_element>>,   kCpuAvx            },
+	{ "Avx",      "double", &RunTyped<f64_element, AvxTypedCopy<f64_element>>,   kCpuAvx            },
+	{ "Avx",      "int32",  &RunTyped<i32_element, AvxTypedCopy<i32_element>>,   kCpuAvx            },
+	{ "Avx",      "int16",  &RunTyped<i16_element, AvxTypedCopy<i16_element>>,   kCpuAvx            },
+	{ "Avx",      "int8",   &RunTyped<i8_element, AvxTypedCopy<i8_element>>,     kCpuAvx            },
+	{ "Avx",      "half",   &RunTyped<f16_element, AvxTypedCopy<f16_element>>,   kCpuAvx | kCpuF16c },
+};
+
+// Kernels for stride mode. None needs aligned buffers.
+struct IndexedKernel
+{
+	char const* name;
+	RunIndexedFn run;
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+IndexedKernel const kIndexedKernels[] =
+{
+	{ "for-loop Strided", &RunIndexed<kStrided, NiaveStridedCopy>,  0           },
+	{ "Avx2 Strided",     &RunIndexed<kStrided, Avx2StridedCopy>,   kCpuAvx2    },
+	{ "Avx512 Strided",   &RunIndexed<kStrided, Avx512StridedCopy>, kCpuAvx512f },
+	{ "for-loop Gather",  &RunIndexed<kGather, NiaveGatherCopy>,    0           },
+	{ "Avx2 Gather",      &RunIndexed<kGather, Avx2GatherCopy>,     kCpuAvx2    },
+	{ "Avx512 Gather",    &RunIndexed<kGather, Avx512GatherCopy>,   kCpuAvx512f },
+	{ "for-loop Scatter", &RunIndexed<kScatter, NiaveScatterCopy>,  0           },
+	{ "Avx512 Scatter",   &RunIndexed<kScatter, Avx512ScatterCopy>, kCpuAvx512f },
+};
+
+bool CanRun(Kernel const& kernel, placement const& dp, placement const& sp)
+{
+	return (kernel.isa & gCpuFeatures) == kernel.isa && is_aligned(dp, kernel.alignment) && is_aligned(sp, kernel.alignment);
+}
+
+void PrintColumns(char const* first)
+{
+	std::cout << "[\'" << first << "\'";
+	for(Kernel const& kernel : kKernels)
+		std::cout << ",\'" << kernel.name << "\'";
+}
+
+// Fills a page buffer with value. Fails the run if it could not be
+// mapped.
+float* FillPages(page_buffer const& pages, float value)
+{
+	float* p = pages.data<float>();
+	if(!p)
+	{
+		std::cerr << "failed to map " << format_bytes(pages.size()) << " of " << page_kind_name(pages.kind()) << " pages" << std::endl;
+		std::exit(1);
+	}
+
+	std::fill(p, p + pages.size() / sizeof(float), value);
+	return p;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Moves source and destination together through every float offset
+// from their base alignment.
+void RunAlignmentSweep()
+{
+	std::size_t const max_offset = 64;
+	placement dp(gDestPlacement.base, max_offset);
+	placement sp(gSourcePlacement.base, max_offset);
+	std::vector<float> source(gNumFloats + placement_padding(sp) / sizeof(float), gCheckValue);
+	std::vector<float> dest(gNumFloats + placement_padding(dp) / sizeof(float), 0.f);
+
+	PrintColumns("Offset");
+	for(std::size_t offset = 0; offset <= max_offset; offset += sizeof(float))
+	{
+		dp.offset = offset;
+		sp.offset = offset;
+		std::cout << "],\n" << "[" << offset;
+		for(Kernel const& kernel : kKernels)
+		{
+			trial_stats stats;
+			if(CanRun(kernel, dp, sp))
+				stats = kernel.run(kernel.name, dp, sp, dest.data(), source.data());
+
+			std::cout << "," << ChartValue(stats);
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Moves source and destination offsets independently and renders one
+// throughput heatmap per kernel, so split line loads and split line
+// stores show up as separate bands.
+void RunHeatmap()
+{
+	std::size_t const max_offset = 64;
+	placement dp(gDestPlacement.base, max_offset);
+	placement sp(gSourcePlacement.base, max_offset);
+	std::vector<float> source(gNumFloats + placement_padding(sp) / sizeof(float), gCheckValue);
+	std::vector<float> dest(gNumFloats + placement_padding(dp) / sizeof(float), 0.f);
+
+	std::vector<std::size_t> offsets;
+	for(std::size_t offset = 0; offset < max_offset; offset += sizeof(float))
+		offsets.push_back(offset);
+
+	for(Kernel const& kernel : kKernels)
+	{
+		std::vector<double> cells(offsets.size() * offsets.size());
+		for(std::size_t s = 0; s < offsets.size(); ++s)
+		{
+			sp.offset = offsets[s];
+			for(std::size_t d = 0; d < offsets.size(); ++d)
+			{
+				dp.offset = offsets[d];
+				if(CanRun(kernel, dp, sp))
+				{
+					trial_stats stats = kernel.run(kernel.name, dp, sp, dest.data(), source.data());
+					cells[s * offsets.size() + d] = GigabytesPerSecond(stats);
+				}
+			}
+		}
+
+		if(gHtmlOut)
+		{
+			heatmap_table(std::cout, kernel.name, "src", "dst", offsets, offsets, cells);
+		}
+		else
+		{
+			std::cout << kernel.name << "\n";
+			for(std::size_t s = 0; s < offsets.size(); ++s)
+			{
+				std::cout << offsets[s];
+				for(std::size_t d = 0; d < offsets.size(); ++d)
+					std::cout << "," << cells[s * offsets.size() + d];
+				std::cout << "\n";
+			}
+		}
+	}
+}
+
+// Sweeps the distance from source to destination modulo 4 KiB with
+// both buffers page based, and flags distances whose bandwidth falls
+// well below the kernel's median as aliasing cliffs.
+void RunAliasingSweep()
+{
+	std::vector<std::size_t> distances = aliasing_distances(kPageBytes, gAliasStep, gAliasWindow, sizeof(float));
+	placement sp(kPageBytes, 0);
+	placement dp(kPageBytes, 0);
+	std::vector<float> source(gNumFloats + placement_padding(placement(kPageBytes, kPageBytes)) / sizeof(float), gCheckValue);
+	std::vector<float> dest(gNumFloats + placement_padding(placement(kPageBytes, kPageBytes)) / sizeof(float), 0.f);
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(distances.size()));
+
+	PrintColumns("Distance dst-src (bytes)");
+	for(std::size_t i = 0; i < distances.size(); ++i)
+	{
+		dp.offset = distances[i];
+		std::cout << "],\n" << "[" << distances[i];
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			if(CanRun(kernel, dp, sp))
+			{
+				trial_stats stats = kernel.run(kernel.name, dp, sp, dest.data(), source.data());
+				bandwidth[k][i] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << bandwidth[k][i];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		for(std::size_t i : detect_cliffs(bandwidth[k], gAliasThreshold))
+		{
+			std::cerr << "aliasing cliff: " << kKernels[k].name
+					  << " dst-src " << distances[i] << " bytes "
+					  << bandwidth[k][i] << " GB/s" << std::endl;
+		}
+	}
+}
+
+// Runs every kernel at each size from 1 to tail-max-floats, where the
+// tail strategy is most of the work, and plots cycles per call.
+void RunTailSweep()
+{
+	std::vector<float> source(gTailMaxFloats + placement_padding(gSourcePlacement) / sizeof(float), gCheckValue);
+	std::vector<float> dest(gTailMaxFloats + placement_padding(gDestPlacement) / sizeof(float), 0.f);
+
+	PrintColumns("Floats");
+	for(std::size_t n = 1; n <= gTailMaxFloats; ++n)
+	{
+		gNumFloats = n;
+		gTotalFloats = (gTailTotalFloats + n - 1) / n * n;
+		std::cout << "],\n" << "[" << n;
+		for(Kernel const& kernel : kKernels)
+		{
+			trial_stats stats;
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+				stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest.data(), source.data());
+
+			std::cout << "," << CyclesPerFloat(stats) * n;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Walks the working set (source plus destination) from L1 sized to
+// DRAM sized and plots bandwidth. Buffers use the src/dst placements
+// from the command line.
+void RunSizeSweep()
+{
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::size_t const bytes_per_float = kStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	page_buffer source_pages((max_floats + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_floats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(sizes.size()));
+	std::vector<std::size_t> working_sets(sizes.size());
+
+	PrintColumns("Working Set (KiB)");
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+	{
+		// Whole cache lines per buffer so every vector width divides.
+		gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+		gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+		working_sets[s] = gNumFloats * bytes_per_float;
+
+		std::cout << "],\n" << "[" << working_sets[s] / 1024.0;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				trial_stats stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest, source);
+				bandwidth[k][s] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << bandwidth[k][s];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		std::cerr << "knees for " << kKernels[k].name << ":";
+		for(knee const& kn : detect_knees(bandwidth[k]))
+		{
+			std::cerr << " " << format_bytes(working_sets[kn.first])
+					  << "-" << format_bytes(working_sets[kn.last])
+					  << " (-" << kn.drop * 100 << "%)";
+		}
+
+		std::cerr << std::endl;
+	}
+
+	// Where the string instructions beat std::memcpy, to check the
+	// sizes glibc switches to rep movsb at on this host.
+	std::size_t memcpy_kernel = 0;
+	while(memcpy_kernel < num_kernels && std::strcmp(kKernels[memcpy_kernel].name, "std::memcpy") != 0)
+		++memcpy_kernel;
+
+	for(std::size_t k = 0; k < num_kernels && memcpy_kernel < num_kernels; ++k)
+	{
+		if(std::strncmp(kKernels[k].name, "rep movs", 8) != 0)
+			continue;
+
+		std::cerr << kKernels[k].name << " beats std::memcpy at:";
+		for(std::size_t s = 0; s < sizes.size(); ++s)
+		{
+			if(bandwidth[k][s] > bandwidth[memcpy_kernel][s])
+				std::cerr << " " << format_bytes(working_sets[s]);
+		}
+
+		std::cerr << std::endl;
+	}
+}
+
+// Runs every kernel with 1 to threads pinned threads sharing one DRAM
+// sized buffer and plots the aggregate bandwidth, then reports where
+// each kernel stops scaling.
+void RunThreadSweep(std::vector<int> const& cpus)
+{
+	gNumFloats = gThreadNumFloats;
+	gTotalFloats = (std::max(gThreadTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	page_buffer source_pages((gNumFloats + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer dest_pages((gNumFloats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(gMaxThreads));
+
+	PrintColumns("Threads");
+	for(std::size_t t = 1; t <= gMaxThreads; ++t)
+	{
+		thread_team team(t, cpus);
+		std::cout << "],\n" << "[" << t;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				trial_stats stats = kernel.run_parallel(kernel.name, team, gDestPlacement, gSourcePlacement, dest, source);
+				bandwidth[k][t - 1] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << bandwidth[k][t - 1];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	// Saturation is the first thread count within gSaturationFraction
+	// of the best bandwidth that kernel reached.
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		std::vector<double> const& bw = bandwidth[k];
+		double peak = *std::max_element(bw.begin(), bw.end());
+		if(peak <= 0)
+			continue;
+
+		std::size_t saturated = 0;
+		while(bw[saturated] < gSaturationFraction * peak)
+			++saturated;
+
+		std::cerr << kKernels[k].name << " saturates at " << saturated + 1 << " threads, "
+				  << bw[saturated] << " GB/s of peak " << peak << " GB/s, "
+				  << bw[saturated] / ((saturated + 1) * bw[0]) * 100 << "% scaling efficiency"
+				  << std::endl;
+	}
+}
+
+// Runs every kernel with the source bound to one NUMA node and the
+// destination bound to another, for every pair of nodes, and draws a
+// source x destination node bandwidth heatmap per kernel. The team runs
+// on the cpus of numa-cpu-node, or of the destination node by default,
+// unless cpus= overrides them.
+void RunNumaMatrix(std::vector<int> const& cpus)
+{
+	gNumFloats = gThreadNumFloats;
+	gTotalFloats = (std::max(gThreadTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	std::size_t const source_floats = gNumFloats + placement_padding(gSourcePlacement) / sizeof(float);
+	std::size_t const dest_floats = gNumFloats + placement_padding(gDestPlacement) / sizeof(float);
+
+	std::vector<int> nodes = numa_nodes();
+	std::vector<std::unique_ptr<numa_buffer>> sources;
+	std::vector<std::unique_ptr<numa_buffer>> dests;
+	for(int node : nodes)
+	{
+		sources.emplace_back(new numa_buffer(source_floats * sizeof(float), node, gPageKind));
+		dests.emplace_back(new numa_buffer(dest_floats * sizeof(float), node, gPageKind));
+		if(!sources.back()->data<float>() || !dests.back()->data<float>())
+		{
+			std::cerr << "failed to map buffers for node " << node << std::endl;
+			std::exit(1);
+		}
+
+		float* source = sources.back()->data<float>();
+		std::fill(source, source + source_floats, gCheckValue);
+		float* dest = dests.back()->data<float>();
+		std::fill(dest, dest + dest_floats, 0.f);
+
+		std::cerr << "node " << node
+				  << ": source " << (sources.back()->bound() ? "bound" : "unbound") << " on node " << numa_page_node(source)
+				  << ", dest " << (dests.back()->bound() ? "bound" : "unbound") << " on node " << numa_page_node(dest)
+				  << ", cpus";
+		for(int cpu : numa_node_cpus(node))
+			std::cerr << " " << cpu;
+		std::cerr << std::endl;
+	}
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> cells(num_kernels, std::vector<double>(nodes.size() * nodes.size()));
+	for(std::size_t d = 0; d < nodes.size(); ++d)
+	{
+		std::vector<int> team_cpus = cpus;
+		if(team_cpus.empty())
+			team_cpus = numa_node_cpus(gNumaCpuNode >= 0 ? gNumaCpuNode : nodes[d]);
+
+		std::size_t threads = gNumaThreads != 0 ? gNumaThreads : std::max<std::size_t>(1, team_cpus.size());
+		thread_team team(threads, team_cpus);
+		for(std::size_t s = 0; s < nodes.size(); ++s)
+		{
+			float* source = sources[s]->data<float>();
+			float* dest = dests[d]->data<float>();
+			for(std::size_t k = 0; k < num_kernels; ++k)
+			{
+				Kernel const& kernel = kKernels[k];
+				if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+				{
+					trial_stats stats = kernel.run_parallel(kernel.name, team, gDestPlacement, gSourcePlacement, dest, source);
+					cells[k][s * nodes.size() + d] = GigabytesPerSecond(stats);
+				}
+			}
+		}
+	}
+
+	std::vector<std::size_t> labels(nodes.begin(), nodes.end());
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		if(gHtmlOut)
+		{
+			heatmap_table(std::cout, kKernels[k].name, "src node", "dst node", labels, labels, cells[k]);
+		}
+		else
+		{
+			std::cout << kKernels[k].name << "\n";
+			for(std::size_t s = 0; s < nodes.size(); ++s)
+			{
+				std::cout << labels[s];
+				for(std::size_t d = 0; d < nodes.size(); ++d)
+					std::cout << "," << cells[k][s * nodes.size() + d];
+				std::cout << "\n";
+			}
+		}
+	}
+}
+
+// Runs every kernel over DRAM sized buffers backed by each page kind and
+// reports the change in bandwidth against 4k pages. Kinds the host
+// cannot map, such as hugetlb sizes with no reserved pages, stay at 0.
+void RunPageSweep()
+{
+	gNumFloats = gPagesNumFloats;
+	gTotalFloats = (std::max(gPagesTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	std::size_t const source_floats = gNumFloats + placement_padding(gSourcePlacement) / sizeof(float);
+	std::size_t const dest_floats = gNumFloats + placement_padding(gDestPlacement) / sizeof(float);
+	std::cerr << "transparent_hugepage " << read_sysfs_line("/sys/kernel/mm/transparent_hugepage/enabled") << std::endl;
+
+	page_kind const kinds[] = { page_kind::small, page_kind::thp, page_kind::huge_2m, page_kind::huge_1g };
+	std::size_t const num_kinds = sizeof(kinds) / sizeof(kinds[0]);
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(num_kinds));
+
+	PrintColumns("Pages");
+	for(std::size_t p = 0; p < num_kinds; ++p)
+	{
+		page_buffer source_pages(source_floats * sizeof(float), kinds[p]);
+		page_buffer dest_pages(dest_floats * sizeof(float), kinds[p]);
+		bool const mapped = source_pages.data<float>() && dest_pages.data<float>();
+		if(!mapped)
+			std::cerr << page_kind_name(kinds[p]) << " pages unavailable" << std::endl;
+
+		std::cout << "],\n" << "[\'" << page_kind_name(kinds[p]) << "\'";
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			if(mapped && CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				float* source = FillPages(source_pages, gCheckValue);
+				float* dest = FillPages(dest_pages, 0.f);
+				trial_stats stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest, source);
+				bandwidth[k][p] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << bandwidth[k][p];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		std::vector<double> const& bw = bandwidth[k];
+		if(bw[0] <= 0)
+			continue;
+
+		std::cerr << kKernels[k].name << " vs 4k:";
+		for(std::size_t p = 1; p < num_kinds; ++p)
+		{
+			std::cerr << " " << page_kind_name(kinds[p]) << " ";
+			if(bw[p] > 0)
+				std::cerr << std::showpos << (bw[p] / bw[0] - 1) * 100 << std::noshowpos << "%";
+			else
+				std::cerr << "n/a";
+		}
+
+		std::cerr << std::endl;
+	}
+}
+
+// Runs single passes of every kernel into freshly mapped destinations
+// under each fault policy and plots the bandwidth including setup, which
+// is what a copy into a newly allocated buffer really costs. The fault
+// cost is reported as the cold pass less the warm one.
+void RunFaultSweep(std::vector<int> const& cpus)
+{
+	gNumFloats = gFaultNumFloats;
+	gTotalFloats = gNumFloats;
+	std::vector<float> source(gNumFloats + placement_padding(gSourcePlacement) / sizeof(float), gCheckValue);
+	thread_team team(gFaultThreads, cpus);
+
+	fault_policy const policies[] = { fault_policy::cold, fault_policy::populate, fault_policy::prefault, fault_policy::warm };
+	std::size_t const num_policies = sizeof(policies) / sizeof(policies[0]);
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<cold_stats>> stats(num_kernels, std::vector<cold_stats>(num_policies));
+
+	PrintColumns("Destination");
+	for(std::size_t p = 0; p < num_policies; ++p)
+	{
+		std::cout << "],\n" << "[\'" << fault_policy_name(policies[p]) << "\'";
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			double bandwidth = 0;
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				stats[k][p] = kernel.run_cold(kernel.name, policies[p], team, gDestPlacement, gSourcePlacement, source.data());
+				trial_stats total = stats[k][p].run;
+				total.median += stats[k][p].setup.median;
+				bandwidth = GigabytesPerSecond(total);
+			}
+
+			std::cout << "," << bandwidth;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	std::size_t const pages = (gNumFloats * sizeof(float) + page_kind_bytes(gPageKind) - 1) / page_kind_bytes(gPageKind);
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		cold_stats const& cold = stats[k][0];
+		cold_stats const& warm = stats[k][num_policies - 1];
+		if(cold.run.count == 0)
+			continue;
+
+		double fault_seconds = cold.run.median - warm.run.median;
+		std::cerr << kKernels[k].name
+				  << ": faults " << fault_seconds * 1e3 << " ms of " << cold.run.median * 1e3 << " ms cold"
+				  << " (" << seconds_to_cycles(fault_seconds) / pages << " cycles/page)";
+		for(std::size_t p = 1; p + 1 < num_policies; ++p)
+		{
+			std::cerr << ", " << fault_policy_name(policies[p])
+					  << " setup " << stats[k][p].setup.median * 1e3 << " ms"
+					  << " + run " << stats[k][p].run.median * 1e3 << " ms";
+		}
+
+		std::cerr << std::endl;
+	}
+}
+
+// Finds the copy size from which streaming stores beat cached ones on
+// this host. Both sides are the same unaligned loop, AVX when the host
+// has it, so the store type is the only difference. The threshold is
+// the smallest size from which streaming wins at every larger size,
+// and it becomes the copy() policy for the rest of the run.
+void RunNtThresholdSweep()
+{
+	bool const avx = (gCpuFeatures & kCpuAvx) != 0;
+	RunFn const cached = avx ? &Run<UnalignedAvxCopy> : &Run<UnalignedSseCopy>;
+	RunFn const streamed = avx ? &Run<UnalignedAvxNonTemporalCopy> : &Run<UnalignedSseNonTemporalCopy>;
+	char const* const cached_name = avx ? "Unaligned Avx" : "Unaligned Sse";
+	char const* const streamed_name = avx ? "Unaligned Avx Stream" : "Unaligned Sse Stream";
+
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::size_t const bytes_per_float = kStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	page_buffer source_pages((max_floats + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_floats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::vector<std::size_t> copy_bytes(sizes.size());
+	std::vector<double> cached_bw(sizes.size());
+	std::vector<double> streamed_bw(sizes.size());
+	std::vector<double> policy_bw(sizes.size());
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+	{
+		gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+		gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+		copy_bytes[s] = gNumFloats * sizeof(float);
+		cached_bw[s] = GigabytesPerSecond(cached(cached_name, gDestPlacement, gSourcePlacement, dest, source));
+		streamed_bw[s] = GigabytesPerSecond(streamed(streamed_name, gDestPlacement, gSourcePlacement, dest, source));
+	}
+
+	std::size_t threshold = std::numeric_limits<std::size_t>::max();
+	for(std::size_t s = sizes.size(); s-- > 0 && streamed_bw[s] >= cached_bw[s];)
+		threshold = copy_bytes[s];
+
+	gCopyPolicy.nt_threshold = threshold;
+	if(threshold == std::numeric_limits<std::size_t>::max())
+		std::cerr << "streaming never wins up to " << format_bytes(copy_bytes.empty() ? 0 : copy_bytes.back()) << ", copy() will not stream" << std::endl;
+	else
+		std::cerr << "nt-threshold=" << threshold << " (" << format_bytes(threshold) << ")" << std::endl;
+
+	// Check the tuned policy tracks the better of the two.
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+	{
+		gNumFloats = copy_bytes[s] / sizeof(float);
+		gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+		policy_bw[s] = GigabytesPerSecond(Run<PolicyCopy>("copy() policy", gDestPlacement, gSourcePlacement, dest, source));
+	}
+
+	std::cout << "[\'Copy Size (KiB)\',\'" << cached_name << "\',\'" << streamed_name << "\',\'copy() policy\'";
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+		std::cout << "],\n" << "[" << copy_bytes[s] / 1024.0 << "," << cached_bw[s] << "," << streamed_bw[s] << "," << policy_bw[s];
+
+	std::cout << "]" << std::endl;
+}
+
+// Sweeps prefetch distance against working set size for every
+// prefetching variant and draws each as a heatmap of its bandwidth as a
+// percentage of the same loop without prefetches. The best distance per
+// size goes to stderr. A non-zero prefetch-distance runs just that one
+// distance instead of the min to max sweep.
+void RunPrefetchSweep()
+{
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::vector<std::size_t> distances;
+	if(gPrefetchDistance != 0)
+	{
+		distances.push_back(gPrefetchDistance);
+	}
+	else
+	{
+		for(std::size_t distance = gPrefetchMinDistance; distance <= gPrefetchMaxDistance; distance *= 2)
+			distances.push_back(distance);
+	}
+
+	std::size_t const bytes_per_float = kStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	page_buffer source_pages((max_floats + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_floats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::vector<std::size_t> working_sets(sizes.size());
+	for(PrefetchKernel const& kernel : kPrefetchKernels)
+	{
+		if((kernel.isa & gCpuFeatures) != kernel.isa)
+			continue;
+
+		std::vector<double> cells(sizes.size() * distances.size());
+		for(std::size_t s = 0; s < sizes.size(); ++s)
+		{
+			gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+			gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+			working_sets[s] = gNumFloats * bytes_per_float;
+			double baseline = GigabytesPerSecond(kernel.baseline(kernel.name, gDestPlacement, gSourcePlacement, dest, source));
+			std::size_t best = 0;
+			for(std::size_t p = 0; p < distances.size(); ++p)
+			{
+				gPrefetchDistance = distances[p];
+				double bandwidth = GigabytesPerSecond(kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest, source));
+				cells[s * distances.size() + p] = baseline > 0 ? bandwidth / baseline * 100 : 0;
+				if(cells[s * distances.size() + p] > cells[s * distances.size() + best])
+					best = p;
+			}
+
+			std::cerr << kernel.name << " at " << format_bytes(working_sets[s])
+					  << ": best distance " << distances[best]
+					  << " (" << cells[s * distances.size() + best] << "% of no prefetch)" << std::endl;
+		}
+
+		if(gHtmlOut)
+		{
+			heatmap_table(std::cout, kernel.name, "working set", "distance", working_sets, distances, cells);
+		}
+		else
+		{
+			std::cout << kernel.name << "\n";
+			for(std::size_t s = 0; s < sizes.size(); ++s)
+			{
+				std::cout << working_sets[s];
+				for(std::size_t p = 0; p < distances.size(); ++p)
+					std::cout << "," << cells[s * distances.size() + p];
+				std::cout << "\n";
+			}
+		}
+	}
+}
+
+// Runs every generated kernel family at each unroll depth over the
+// num-floats buffers and plots bandwidth against unroll. Small buffers
+// show loop overhead and port pressure; DRAM sized ones mostly do not.
+void RunUnrollSweep()
+{
+	std::vector<float> source(gNumFloats + placement_padding(gSourcePlacement) / sizeof(float), gCheckValue);
+	std::vector<float> dest(gNumFloats + placement_padding(gDestPlacement) / sizeof(float), 0.f);
+
+	std::vector<std::string> families;
+	for(UnrolledKernel const& kernel : kUnrolledKernels)
+	{
+		if(std::find(families.begin(), families.end(), kernel.family) == families.end())
+			families.push_back(kernel.family);
+	}
+
+	std::cout << "[\'Unroll\'";
+	for(std::string const& family : families)
+		std::cout << ",\'" << family << "\'";
+
+	for(int unroll = 1; unroll <= 8; unroll *= 2)
+	{
+		std::cout << "],\n" << "[" << unroll;
+		for(std::string const& family : families)
+		{
+			double bandwidth = 0;
+			for(UnrolledKernel const& kernel : kUnrolledKernels)
+			{
+				if(kernel.family != family || kernel.unroll != unroll)
+					continue;
+
+				bool const runnable = (kernel.isa & gCpuFeatures) == kernel.isa
+								   && is_aligned(gDestPlacement, kernel.alignment)
+								   && is_aligned(gSourcePlacement, kernel.alignment);
+				if(runnable)
+				{
+					std::string name = family + " x" + std::to_string(unroll);
+					bandwidth = GigabytesPerSecond(kernel.run(name.c_str(), gDestPlacement, gSourcePlacement, dest.data(), source.data()));
+				}
+			}
+
+			std::cout << "," << bandwidth;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Runs the for-loop and vector copy for every element type over buffers
+// of num-floats floats' worth of bytes, and plots bandwidth per type.
+// Elements per cycle are in the log.
+void RunTypeSweep()
+{
+	std::size_t const bytes = (gNumFloats + kGuardFloats) * sizeof(float);
+	page_buffer source_pages(bytes + placement_padding(gSourcePlacement), gPageKind);
+	page_buffer dest_pages(bytes + placement_padding(gDestPlacement), gPageKind);
+	FillPages(source_pages, 0.f);
+	FillPages(dest_pages, 0.f);
+
+	char const* const kinds[] = { "for-loop", "Vector" };
+	std::vector<std::string> types;
+	for(TypedKernel const& kernel : kTypedKernels)
+	{
+		if(std::find(types.begin(), types.end(), kernel.type) == types.end())
+			types.push_back(kernel.type);
+	}
+
+	std::cout << "[\'Element Type\'";
+	for(char const* kind : kinds)
+		std::cout << ",\'" << kind << "\'";
+
+	for(std::string const& type : types)
+	{
+		std::cout << "],\n" << "[\'" << type << "\'";
+		for(char const* kind : kinds)
+		{
+			double bandwidth = 0;
+			for(TypedKernel const& kernel : kTypedKernels)
+			{
+				bool const is_loop = std::string(kernel.name) == "for-loop";
+				if(kernel.type != type || is_loop != (kind == kinds[0]))
+					continue;
+
+				if((kernel.isa & gCpuFeatures) == kernel.isa)
+				{
+					std::string name = std::string(kernel.name) + " " + type;
+					trial_stats stats = kernel.run(name.c_str(), gDestPlacement, gSourcePlacement, dest_pages.data<void>(), source_pages.data<void>());
+					bandwidth = GigabytesPerSecond(stats);
+				}
+			}
+
+			std::cout << "," << bandwidth;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Runs every memcpy implementation found across the working set sweep:
+// the libc entry points and variants, any from memcpy-lib, the bundled
+// portable baseline, the copy() policy and the SIMD kernels the host
+// can run. Reports the fastest at each size.
+void RunMemcpySweep(std::vector<memcpy_impl> const& impls)
+{
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::size_t const bytes_per_float = kStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	page_buffer source_pages((max_floats + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_floats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::cout << "[\'Working Set (KiB)\'";
+	for(memcpy_impl const& impl : impls)
+		std::cout << ",\'" << impl.name << "\'";
+
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+	{
+		gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+		gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+		std::size_t const working_set = gNumFloats * bytes_per_float;
+
+		std::size_t best = 0;
+		std::vector<double> bandwidth(impls.size());
+		std::cout << "],\n" << "[" << working_set / 1024.0;
+		for(std::size_t i = 0; i < impls.size(); ++i)
+		{
+			gMemcpy = impls[i].fn;
+			bandwidth[i] = GigabytesPerSecond(Run<IndirectMemcpy>(impls[i].name.c_str(), gDestPlacement, gSourcePlacement, dest, source));
+			if(bandwidth[i] > bandwidth[best])
+				best = i;
+
+			std::cout << "," << bandwidth[i];
+		}
+
+		std::cerr << "fastest at " << format_bytes(working_set) << ": " << impls[best].name
+				  << " " << bandwidth[best] << " GB/s" << std::endl;
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Runs the strided and indexed kernels over num-floats floats at every
+// power of two stride from stride-min to stride-max and plots the
+// bandwidth of the floats actually used. Source values vary so a wrong
+// offset fails validation. Reports what each kernel keeps of its
+// smallest stride bandwidth at the largest.
+void RunStrideSweep()
+{
+	gTotalFloats = (std::max(gStrideTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	std::size_t const max_span = gNumFloats * gStrideMax;
+	page_buffer source_pages((max_span + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_span + kGuardFloats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = place(FillPages(source_pages, 0.f), gSourcePlacement);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::vector<std::int32_t> index(gNumFloats);
+	std::mt19937 random(1);
+	std::size_t const num_kernels = sizeof(kIndexedKernels) / sizeof(kIndexedKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels);
+
+	std::cout << "[\'Stride (floats)\'";
+	for(IndexedKernel const& kernel : kIndexedKernels)
+		std::cout << ",\'" << kernel.name << "\'";
+
+	for(std::size_t stride = gStrideMin; stride <= gStrideMax; stride *= 2)
+	{
+		gStride = stride;
+		for(std::size_t i = 0; i < gNumFloats; ++i)
+			index[i] = std::int32_t(i * stride);
+
+		std::shuffle(index.begin(), index.end(), random);
+		for(std::size_t j = 0; j < gNumFloats * stride; ++j)
+			source[j] = gCheckValue + float(j & 0xfff);
+
+		std::cout << "],\n" << "[" << stride;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			IndexedKernel const& kernel = kIndexedKernels[k];
+			double gbps = 0;
+			if((kernel.isa & gCpuFeatures) == kernel.isa)
+				gbps = GigabytesPerSecond(kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest, source_pages.data<float>(), index.data()));
+
+			bandwidth[k].push_back(gbps);
+			std::cout << "," << gbps;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		if(bandwidth[k].empty() || bandwidth[k].front() <= 0)
+			continue;
+
+		std::cerr << kIndexedKernels[k].name << ": " << bandwidth[k].front() << " GB/s at stride " << gStrideMin
+				  << ", " << bandwidth[k].back() / bandwidth[k].front() * 100 << "% of that at stride " << gStride
+				  << std::endl;
+	}
+}
+
+// ----------------------------------------------------------------------------
+//
+void print_usage()
+{
+	std::cerr << "Usage:\n" 
+			  << "copy [options]\n"
+			  << "num-floats=<number of float in memory>    default (" << kDefaultNumFloats << ")\n"
+			  << "total-floats=<number of floats total>     default (" << kDefaultTotalFloats << ")\n"
+			  << "check-value=<any value to check against>  default (" << gCheckValue << ")\n"
+			  << "trials=<measured runs per cell>           default (" << gTrials << ")\n"
+			  << "warmup=<discarded runs per cell>          default (" << gWarmupTrials << ")\n"
+			  << "bootstrap-resamples=<number>              default (" << gBootstrapResamples << ")\n"
+			  << "confidence=<ci level in (0, 1)>           default (" << gConfidence << ")\n"
+			  << "timer=<wall/tsc>                          default (" << timing_backend_name(gTimingBackend) << ")\n"
+			  << "report-cycles=<true/false>                default (" << std::boolalpha << gReportCycles << ")\n"
+			  << "counters=<true/false>                     default (" << std::boolalpha << gCollectCounters << ")\n"
+			  << "mode=<alignment/size/heatmap/aliasing/tail/threads/numa/pages/fault/nt-threshold/prefetch/unroll/memcpy/types/stride> default (" << gMode << ")\n"
+			  << "sweep-min-bytes=<smallest working set>    default (" << gSweepMinBytes << ")\n"
+			  << "sweep-max-bytes=<largest working set>     default (" << gSweepMaxBytes << ")\n"
+			  << "sweep-steps=<sizes per doubling>          default (" << gSweepStepsPerOctave << ")\n"
+			  << "sweep-total-floats=<floats per trial>     default (" << gSweepTotalFloats << ")\n"
+			  << "src-base=<power of two alignment>         default (" << gSourcePlacement.base << ")\n"
+			  << "src-offset=<bytes past src-base>          default (" << gSourcePlacement.offset << ")\n"
+			  << "dst-base=<power of two alignment>         default (" << gDestPlacement.base << ")\n"
+			  << "dst-offset=<bytes past dst-base>          default (" << gDestPlacement.offset << ")\n"
+			  << "alias-step=<bytes between distances>      default (" << gAliasStep << ")\n"
+			  << "alias-window=<fine bytes at page edges>   default (" << gAliasWindow << ")\n"
+			  << "alias-threshold=<cliff fraction>          default (" << gAliasThreshold << ")\n"
+			  << "tail-max-floats=<largest tail mode size>  default (" << gTailMaxFloats << ")\n"
+			  << "tail-total-floats=<floats per trial>      default (" << gTailTotalFloats << ")\n"
+			  << "threads=<most threads in threads mode>    default (" << gMaxThreads << ")\n"
+			  << "cpus=<cpu list to pin threads to>         default (allowed cpus in order)\n"
+			  << "threads-num-floats=<floats per buffer>    default (" << gThreadNumFloats << ")\n"
+			  << "threads-total-floats=<floats per trial>   default (" << gThreadTotalFloats << ")\n"
+			  << "saturation=<fraction of peak bandwidth>   default (" << gSaturationFraction << ")\n"
+			  << "numa-threads=<threads, 0 for whole node>  default (" << gNumaThreads << ")\n"
+			  << "numa-cpu-node=<node, -1 for dst node>     default (" << gNumaCpuNode << ")\n"
+			  << "pages=<default/4k/thp/2m/1g>              default (" << page_kind_name(gPageKind) << ")\n"
+			  << "pages-num-floats=<floats per buffer>      default (" << gPagesNumFloats << ")\n"
+			  << "pages-total-floats=<floats per trial>     default (" << gPagesTotalFloats << ")\n"
+			  << "fault-num-floats=<floats per buffer>      default (" << gFaultNumFloats << ")\n"
+			  << "fault-threads=<prefaulting threads>       default (" << gFaultThreads << ")\n"
+			  << "nt-threshold=<bytes copy() streams from>  default (" << gCopyPolicy.nt_threshold << ")\n"
+			  << "prefetch-distance=<bytes ahead, 0 sweeps> default (" << gPrefetchDistance << ")\n"
+			  << "prefetch-min-distance=<bytes ahead>       default (" << gPrefetchMinDistance << ")\n"
+			  << "prefetch-max-distance=<bytes ahead>       default (" << gPrefetchMaxDistance << ")\n"
+			  << "memcpy-lib=<shared library to load>       default ()\n"
+			  << "memcpy-symbols=<memcpys in memcpy-lib>    default (" << gMemcpySymbols << ")\n"
+			  << "stride-min=<smallest stride in floats>    default (" << gStrideMin << ")\n"
+			  << "stride-max=<largest stride in floats>     default (" << gStrideMax << ")\n"
+			  << "stride-total-floats=<floats per trial>    default (" << gStrideTotalFloats << ")\n"
+			  << "disable-isa=<comma separated features>    default ()\n"
+			  << "report-html=<true/false>                  default (" << std::boolalpha << gHtmlOut << ")\n"
+			  << std::endl;
+
+}
+
+// ----------------------------------------------------------------------------
+//
+int main(int argc, char** argv)
+{
+	cgutil::program_options opts;
+	opts.add("num-floats", gNumFloats);
+	opts.add("num-floats", gNumFloats);
+	opts.add("total-floats", gTotalFloats);
+	opts.add("check-value", gCheckValue);
+	opts.add("trials", gTrials);
+	opts.add("warmup", gWarmupTrials);
+	opts.add("bootstrap-resamples", gBootstrapResamples);
+	opts.add("confidence", gConfidence);
+	std::string timer = timing_backend_name(gTimingBackend);
+	opts.add("timer", timer);
+	opts.add("report-cycles", gReportCycles);
+	opts.add("counters", gCollectCounters);
+	opts.add("mode", gMode);
+	opts.add("sweep-min-bytes", gSweepMinBytes);
+	opts.add("sweep-max-bytes", gSweepMaxBytes);
+	opts.add("sweep-steps", gSweepStepsPerOctave);
+	opts.add("sweep-total-floats", gSweepTotalFloats);
+	opts.add("src-base", gSourcePlacement.base);
+	opts.add("src-offset", gSourcePlacement.offset);
+	opts.add("dst-base", gDestPlacement.base);
+	opts.add("dst-offset", gDestPlacement.offset);
+	opts.add("alias-step", gAliasStep);
+	opts.add("alias-window", gAliasWindow);
+	opts.add("alias-threshold", gAliasThreshold);
+	opts.add("tail-max-floats", gTailMaxFloats);
+	opts.add("tail-total-floats", gTailTotalFloats);
+	opts.add("threads", gMaxThreads);
+	std::string cpu_list;
+	opts.add("cpus", cpu_list);
+	opts.add("threads-num-floats", gThreadNumFloats);
+	opts.add("threads-total-floats", gThreadTotalFloats);
+	opts.add("saturation", gSaturationFraction);
+	opts.add("numa-threads", gNumaThreads);
+	opts.add("numa-cpu-node", gNumaCpuNode);
+	std::string pages = page_kind_name(gPageKind);
+	opts.add("pages", pages);
+	opts.add("pages-num-floats", gPagesNumFloats);
+	opts.add("pages-total-floats", gPagesTotalFloats);
+	opts.add("fault-num-floats", gFaultNumFloats);
+	opts.add("fault-threads", gFaultThreads);
+	opts.add("nt-threshold", gCopyPolicy.nt_threshold);
+	opts.add("prefetch-distance", gPrefetchDistance);
+	opts.add("prefetch-min-distance", gPrefetchMinDistance);
+	opts.add("prefetch-max-distance", gPrefetchMaxDistance);
+	opts.add("memcpy-lib", gMemcpyLibrary);
+	opts.add("memcpy-symbols", gMemcpySymbols);
+	opts.add("stride-min", gStrideMin);
+	opts.add("stride-max", gStrideMax);
+	opts.add("stride-total-floats", gStrideTotalFloats);
+	std::string disabled_isa;
+	opts.add("disable-isa", disabled_isa);
+	
+	try
+	{
+		opts.parse(argc, argv);
+	}
+	catch(std::runtime_error e)
+	{
+		std::cerr << e.what() << std::endl;
+		print_usage();
+		std::exit(1);
+	}
+
+	if(gTotalFloats < gNumFloats)
+	{
+		std::cerr << "total-floats must be greater than num-floats" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(!parse_timing_backend(timer, gTimingBackend))
+	{
+		std::cerr << "unknown timer " << timer << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(!parse_page_kind(pages, gPageKind))
+	{
+		std::cerr << "unknown page kind " << pages << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	unsigned disabled = 0;
+	if(!parse_cpu_features(disabled_isa, disabled))
+	{
+		std::cerr << "unknown feature in " << disabled_isa << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	gCpuFeatures = cpu_features() & ~with_dependent_features(disabled);
+	gCopyPolicy.features = gCpuFeatures;
+	std::cerr << "cpu ";
+	print_cpu_features(std::cerr, gCpuFeatures);
+	std::cerr << std::endl;
+
+	// The string kernels always run; these only say how fast rep movsb
+	// can be expected to be.
+	std::cerr << "rep movsb: erms " << ((cpu_features() & kCpuErms) ? "yes" : "no")
+			  << ", fsrm " << ((cpu_features() & kCpuFsrm) ? "yes" : "no")
+			  << std::endl;
+
+	std::cerr << "tsc " << tsc_frequency() / 1e9 << " GHz, "
+			  << "timer overhead " << tsc_overhead() << " cycles (tsc) "
+			  << wall_overhead() << " seconds (wall)"
+			  << std::endl
+	;
+
+	if(gCollectCounters)
+	{
+		gCounters.open();
+		if(!gCounters.available())
+			std::cerr << "perf_event_open unavailable, counters disabled" << std::endl;
+	}
+
+	if(gTrials == 0 || gConfidence <= 0 || gConfidence >= 1)
+	{
+		std::cerr << "trials must be non-zero and confidence in (0, 1)" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(!is_valid_placement<float>(gSourcePlacement) || !is_valid_placement<float>(gDestPlacement))
+	{
+		std::cerr << "bases must be powers of two and offsets multiples of " << sizeof(float) << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gAliasStep == 0 || gAliasWindow >= kPageBytes / 2)
+	{
+		std::cerr << "alias-step must be non-zero and alias-window less than " << kPageBytes / 2 << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMode != "alignment" && gMode != "size" && gMode != "heatmap" && gMode != "aliasing" && gMode != "tail" && gMode != "threads" && gMode != "numa" && gMode != "pages" && gMode != "fault" && gMode != "nt-threshold" && gMode != "prefetch" && gMode != "unroll" && gMode != "memcpy" && gMode != "types" && gMode != "stride")
+	{
+		std::cerr << "unknown mode " << gMode << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	std::vector<int> cpus;
+	if(!parse_cpu_list(cpu_list, cpus))
+	{
+		std::cerr << "bad cpu list " << cpu_list << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMaxThreads == 0 || gThreadNumFloats == 0 || gFaultThreads == 0 || gSaturationFraction <= 0 || gSaturationFraction > 1)
+	{
+		std::cerr << "threads, threads-num-floats and fault-threads must be non-zero and saturation in (0, 1]" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMode == "stride" && (gStrideMin == 0 || gStrideMax < gStrideMin || gNumFloats * gStrideMax > std::size_t(std::numeric_limits<std::int32_t>::max())))
+	{
+		std::cerr << "stride-min must be non-zero and no more than stride-max, and num-floats * stride-max must fit an int32 index" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMode == "heatmap")
+	{
+		if(gHtmlOut)
+			heatmap_begin(std::cout, "Source vs. Destination Offset (GB/s)");
+
+		RunHeatmap();
+
+		if(gHtmlOut)
+			heatmap_end(std::cout);
+
+		return 0;
+	}
+
+	if(gMode == "prefetch")
+	{
+		if(gPrefetchMinDistance == 0 || gPrefetchMaxDistance < gPrefetchMinDistance)
+		{
+			std::cerr << "prefetch-min-distance must be non-zero and no more than prefetch-max-distance" << std::endl;
+			print_usage();
+			return 0;
+		}
+
+		if(gHtmlOut)
+			heatmap_begin(std::cout, "Prefetch Distance vs. Working Set (% of no prefetch bandwidth)");
+
+		RunPrefetchSweep();
+
+		if(gHtmlOut)
+			heatmap_end(std::cout);
+
+		return 0;
+	}
+
+	if(gMode == "numa")
+	{
+		if(gHtmlOut)
+			heatmap_begin(std::cout, "Source vs. Destination NUMA Node (GB/s)");
+
+		RunNumaMatrix(cpus);
+
+		if(gHtmlOut)
+			heatmap_end(std::cout);
+
+		return 0;
+	}
+
+	if(gHtmlOut)
+		html_begin(std::cout);
+
+	std::string options;
+	char const* chart = "LineChart";
+	if(gMode == "stride")
+	{
+		RunStrideSweep();
+		options = "title: 'Stride vs. Bandwidth of Used Floats',\n"
+				  "          hAxis: {title: 'Stride (floats)', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "types")
+	{
+		RunTypeSweep();
+		chart = "ColumnChart";
+		options = "title: 'Element Type vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Element Type'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "memcpy")
+	{
+		std::vector<memcpy_impl> impls;
+		find_libc_memcpys(impls);
+		if(!gMemcpyLibrary.empty() && !find_library_memcpys(gMemcpyLibrary, gMemcpySymbols, impls))
+			std::cerr << "cannot load " << gMemcpyLibrary << std::endl;
+
+		impls.push_back(memcpy_impl{ "portable", &portable_memcpy });
+		impls.push_back(memcpy_impl{ "copy() policy", &PolicyMemcpy });
+		if(gCpuFeatures & kCpuAvx)
+		{
+			impls.push_back(memcpy_impl{ "Unaligned Avx", &KernelMemcpy<UnalignedAvxCopy> });
+			impls.push_back(memcpy_impl{ "Unaligned Avx Stream", &KernelMemcpy<UnalignedAvxNonTemporalCopy> });
+		}
+
+		if(gCpuFeatures & kCpuAvx512f)
+			impls.push_back(memcpy_impl{ "Unaligned Avx512", &KernelMemcpy<UnalignedAvx512Copy> });
+		RunMemcpySweep(impls);
+		options = "title: 'Working Set vs. memcpy Bandwidth',\n"
+				  "          hAxis: {title: 'Working Set (KiB)', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "unroll")
+	{
+		RunUnrollSweep();
+		options = "title: 'Unroll Depth vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Vectors per Iteration', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "nt-threshold")
+	{
+		RunNtThresholdSweep();
+		options = "title: 'Copy Size vs. Cached and Streaming Store Bandwidth',\n"
+				  "          hAxis: {title: 'Copy Size (KiB)', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "fault")
+	{
+		RunFaultSweep(cpus);
+		chart = "ColumnChart";
+		options = "title: 'Destination Fault Policy vs. Bandwidth Including Setup',\n"
+				  "          hAxis: {title: 'Destination'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "pages")
+	{
+		RunPageSweep();
+		chart = "ColumnChart";
+		options = "title: 'Page Size vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Pages'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "threads")
+	{
+		RunThreadSweep(cpus);
+		options = "title: 'Threads vs. Aggregate Bandwidth',\n"
+				  "          hAxis: {title: 'Threads'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "tail")
+	{
+		RunTailSweep();
+		options = "title: 'Size vs. Cycles per Call',\n"
+				  "          hAxis: {title: 'Floats'},\n"
+				  "          vAxis: {title: 'Cycles'}";
+	}
+	else if(gMode == "aliasing")
+	{
+		RunAliasingSweep();
+		options = "title: 'Buffer Distance mod 4 KiB vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Distance (bytes)'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "size")
+	{
+		RunSizeSweep();
+		options = "title: 'Working Set vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Working Set (KiB)', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else
+	{
+		RunAlignmentSweep();
+		options = std::string("title: 'Offset vs. ") + (gReportCycles ? "Cycles per Float" : "Run Time") + "'";
+	}
+
+	if(gHtmlOut)
+		html_end(std::cout, chart, options);
 
 	return 0;
 }
\ No newline at end of file
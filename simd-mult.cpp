@@ -1,296 +1,3595 @@
 // simd-mult.cpp
 // 
 // cl.exe /EHsc /Ox simd-mult.cpp
-// g++ -std=c++11 -O3 simd-mult.cpp
+// g++ -std=c++11 -O3 simd-mult.cpp -pthread
 //
-// or
-// 
-// cl.exe /EHsc /Ox /arch:AVX2 simd-copy.cpp
-// g++ -std=c++11 -O3 -march=core-avx2 -mtune=core-avx2 -mavx2 
+// No -march or /arch flags are needed. Kernels that use instructions
+// beyond the baseline carry their own target attributes and are only
+// run when CPUID reports the host supports them.
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <immintrin.h>
 #include <cassert>
 #include "cgutil/program_options.h"
 #include "cgutil/timer.h"
-
-#ifndef SUPPORT_AVX
-#  define SUPPORT_AVX 1
-#endif
-
-template<typename T>
-T* align(T* p, std::size_t aligned_to)
-{
-	std::size_t address = reinterpret_cast<std::size_t>(p);
-	while(address % 256 != aligned_to)
-		++address;
-	return reinterpret_cast<T*>(address);
-}
+#include "cpu-features.h"
+#include "element-types.h"
+#include "numa.h"
+#include "pages.h"
+#include "perf-counters.h"
+#include "placement.h"
+#include "prefetch.h"
+#include "report.h"
+#include "sweep.h"
+#include "threads.h"
+#include "timing.h"
+#include "trials.h"
+#include "vector-ops.h"
 
 // ----------------------------------------------------------------------------
 //
 std::size_t kDefaultNumFloats = 16 * 1024;
 std::size_t kDefaultTotalFloats = 65636 * kDefaultNumFloats;
+std::size_t const kStreamsPerFloat = 3; // two loads, one store
+std::size_t const kFmaStreamsPerFloat = 4; // three loads, one store
+std::size_t const kGuardFloats = kCacheLineBytes / sizeof(float);
 std::size_t gNumFloats = kDefaultNumFloats;
 std::size_t gTotalFloats = kDefaultTotalFloats;
 float gCheckValue = 1.f;
-bool gHasAvx = true;
+std::size_t gTrials = 7;
+std::size_t gWarmupTrials = 1;
+std::size_t gBootstrapResamples = 1000;
+double gConfidence = 0.95;
+timing_backend gTimingBackend = timing_backend::tsc;
+bool gReportCycles = false;
+bool gCollectCounters = false;
+perf_counters gCounters;
+std::string gMode = "alignment";
+std::size_t gSweepMinBytes = 1024;
+std::size_t gSweepMaxBytes = std::size_t(1) << 30;
+std::size_t gSweepStepsPerOctave = 2;
+std::size_t gSweepTotalFloats = 64 * 1024 * 1024;
+placement gSourcePlacement;
+placement gDestPlacement;
+std::size_t gAliasStep = 64;
+std::size_t gAliasWindow = 64;
+double gAliasThreshold = 0.15;
+unsigned gCpuFeatures = 0;
+std::size_t gTailMaxFloats = 67;
+std::size_t gTailTotalFloats = 1024 * 1024;
+std::size_t gMaxThreads = std::max(1u, std::thread::hardware_concurrency());
+std::size_t gThreadNumFloats = 16 * 1024 * 1024;
+std::size_t gThreadTotalFloats = 64 * 1024 * 1024;
+double gSaturationFraction = 0.95;
+std::size_t gNumaThreads = 1;
+int gNumaCpuNode = -1;
+page_kind gPageKind = page_kind::system;
+std::size_t gPagesNumFloats = 16 * 1024 * 1024;
+std::size_t gPagesTotalFloats = 64 * 1024 * 1024;
+std::size_t gFaultNumFloats = 16 * 1024 * 1024;
+std::size_t gFaultThreads = std::max(1u, std::thread::hardware_concurrency());
+std::size_t gPrefetchDistance = 0;
+std::size_t gPrefetchMinDistance = 64;
+std::size_t gPrefetchMaxDistance = 4096;
+std::size_t gStride = 1;
+std::size_t gStrideMin = 1;
+std::size_t gStrideMax = 64;
+std::size_t gStrideTotalFloats = 16 * 1024 * 1024;
+std::size_t gStreamNumFloats = 32 * 1024 * 1024;
 bool gHtmlOut = true;
 
-void NiaveMult(float* d, float const* a, float const* b)
+void NiaveMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; ++i)
+	for(int i = 0; i < n; ++i)
 	{
 		*d++ = *a++ * *b++;
 	}
 }
 
-void UnalignedSseMult(float* d, float const* a, float const* b)
+// Strided and indexed kernels for stride mode. The strided kernels
+// read a and b at every gStride'th float. Gather reads a[index[i]] and
+// b[index[i]] and scatter writes d[index[i]], where index holds the
+// strided offsets in a random order, so all three touch the same lines.
+enum access_pattern
+{
+	kStrided,
+	kGather,
+	kScatter,
+};
+
+void NiaveStridedMult(float* d, float const* a, float const* b, std::int32_t const*, std::size_t n)
+{
+	std::size_t const stride = gStride;
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = a[i * stride] * b[i * stride];
+}
+
+SIMDPERF_TARGET("avx2")
+void Avx2StridedMult(float* d, float const* a, float const* b, std::int32_t const*, std::size_t n)
+{
+	std::size_t const stride = gStride;
+	__m256i const offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(int(stride)));
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		__m256 v1 = _mm256_i32gather_ps(&a[i * stride], offsets, 4);
+		__m256 v2 = _mm256_i32gather_ps(&b[i * stride], offsets, 4);
+		_mm256_storeu_ps(&d[i], _mm256_mul_ps(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = a[i * stride] * b[i * stride];
+}
+
+SIMDPERF_TARGET("avx512f")
+void Avx512StridedMult(float* d, float const* a, float const* b, std::int32_t const*, std::size_t n)
+{
+	// The masked gathers, because GCC 12 warns about the undefined
+	// source of the plain ones.
+	std::size_t const stride = gStride;
+	__m512i const offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(int(stride)));
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512 v1 = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, offsets, &a[i * stride], 4);
+		__m512 v2 = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, offsets, &b[i * stride], 4);
+		_mm512_storeu_ps(&d[i], _mm512_mul_ps(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = a[i * stride] * b[i * stride];
+}
+
+void NiaveGatherMult(float* d, float const* a, float const* b, std::int32_t const* index, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = a[index[i]] * b[index[i]];
+}
+
+SIMDPERF_TARGET("avx2")
+void Avx2GatherMult(float* d, float const* a, float const* b, std::int32_t const* index, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		__m256i offsets = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&index[i]));
+		__m256 v1 = _mm256_i32gather_ps(a, offsets, 4);
+		__m256 v2 = _mm256_i32gather_ps(b, offsets, 4);
+		_mm256_storeu_ps(&d[i], _mm256_mul_ps(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = a[index[i]] * b[index[i]];
+}
+
+SIMDPERF_TARGET("avx512f")
+void Avx512GatherMult(float* d, float const* a, float const* b, std::int32_t const* index, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512i offsets = _mm512_loadu_si512(&index[i]);
+		__m512 v1 = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, offsets, a, 4);
+		__m512 v2 = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, offsets, b, 4);
+		_mm512_storeu_ps(&d[i], _mm512_mul_ps(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = a[index[i]] * b[index[i]];
+}
+
+void NiaveScatterMult(float* d, float const* a, float const* b, std::int32_t const* index, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[index[i]] = a[i] * b[i];
+}
+
+// AVX2 has gathers but no scatter.
+SIMDPERF_TARGET("avx512f")
+void Avx512ScatterMult(float* d, float const* a, float const* b, std::int32_t const* index, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512i offsets = _mm512_loadu_si512(&index[i]);
+		_mm512_i32scatter_ps(d, offsets, _mm512_mul_ps(_mm512_loadu_ps(&a[i]), _mm512_loadu_ps(&b[i])), 4);
+	}
+
+	for(; i < n; ++i)
+		d[index[i]] = a[i] * b[i];
+}
+
+// Lane mask with the first count lanes set, for maskload/maskstore.
+SIMDPERF_TARGET("avx")
+inline __m256i AvxTailMask(int count)
+{
+	static int const lanes[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+	return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&lanes[8 - count]));
+}
+
+SIMDPERF_TARGET("sse2")
+void UnalignedSseMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 4)
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
 	{
 		__m128 v1 = _mm_loadu_ps(&a[i]);
 		__m128 v2 = _mm_loadu_ps(&b[i]);
 		__m128 r = _mm_mul_ps(v1, v2);
 		_mm_storeu_ps(&d[i], r);
 	}
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
 }
 
-void AlignedSseMult(float* d, float const* a, float const* b)
+SIMDPERF_TARGET("sse2")
+void AlignedSseMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 4)
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
 	{
 		__m128 v1 = _mm_load_ps(&a[i]);
 		__m128 v2 = _mm_load_ps(&b[i]);
 		__m128 r = _mm_mul_ps(v1, v2);
 		_mm_store_ps(&d[i], r);
 	}
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
 }
 
-void AlignedSseNonTemporalMult(float* d, float const* a, float const* b)
+SIMDPERF_TARGET("sse2")
+void AlignedSseNonTemporalMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 4)
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
 	{
 		__m128 v1 = _mm_load_ps(&a[i]);
 		__m128 v2 = _mm_load_ps(&b[i]);
 		__m128 r = _mm_mul_ps(v1, v2);
 		_mm_stream_ps(&d[i], r);
 	}
+
+	// Streaming stores are weakly ordered; fence them so they are
+	// globally visible before anything after the kernel.
+	_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
 }
 
-#if SUPPORT_AVX
-void UnalignedAvxMult(float* d, float const* a, float const* b)
+SIMDPERF_TARGET("avx")
+void UnalignedAvxMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 8)
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
 		__m256 v1 = _mm256_loadu_ps(&a[i]);
 		__m256 v2 = _mm256_loadu_ps(&b[i]);
 		__m256 r = _mm256_mul_ps(v1, v2);
 		_mm256_storeu_ps(&d[i], r);
 	}
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
 }
 
-void AlignedAvxMult(float* d, float const* a, float const* b)
+SIMDPERF_TARGET("avx")
+void AlignedAvxMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 8)
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
 		__m256 v1 = _mm256_load_ps(&a[i]);
 		__m256 v2 = _mm256_load_ps(&b[i]);
 		__m256 r = _mm256_mul_ps(v1, v2);
 		_mm256_store_ps(&d[i], r);
 	}
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
 }
 
-void AlignedAvxNonTemporalMult(float* d, float const* a, float const* b)
+SIMDPERF_TARGET("avx")
+void AlignedAvxNonTemporalMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	for(int i = 0; i < gNumFloats; i += 8)
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
 		__m256 v1 = _mm256_load_ps(&a[i]);
 		__m256 v2 = _mm256_load_ps(&b[i]);
 		__m256 r = _mm256_mul_ps(v1, v2);
 		_mm256_stream_ps(&d[i], r);
 	}
-}
-#endif
 
-void NullMult(float*, float const*, float const*)
-{}
+	_mm_sfence();
 
-// ----------------------------------------------------------------------------
-//
-template<void(*f)(float*, float const*, float const*)>
-void Run(char const* name, std::size_t alignment, float* d, float const* a, float const* b)
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
+
+SIMDPERF_TARGET("avx512f")
+void UnalignedAvx512Mult(float* d, float const* a, float const* b, std::size_t n)
 {
-	d = align(d, alignment);
-	a = align(a, alignment);
-	b = align(b, alignment);
-	std::fill(d, d + gNumFloats, 0.f);
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512 v1 = _mm512_loadu_ps(&a[i]);
+		__m512 v2 = _mm512_loadu_ps(&b[i]);
+		__m512 r = _mm512_mul_ps(v1, v2);
+		_mm512_storeu_ps(&d[i], r);
+	}
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
 
-	cgutil::timer t;
-	for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+SIMDPERF_TARGET("avx512f")
+void AlignedAvx512Mult(float* d, float const* a, float const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
 	{
-		f(d, a, b);
+		__m512 v1 = _mm512_load_ps(&a[i]);
+		__m512 v2 = _mm512_load_ps(&b[i]);
+		__m512 r = _mm512_mul_ps(v1, v2);
+		_mm512_store_ps(&d[i], r);
 	}
-	float time = t.elapsed();
 
-	for(std::size_t i = 0; i < gNumFloats; ++i)
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
+
+SIMDPERF_TARGET("avx512f")
+void AlignedAvx512NonTemporalMult(float* d, float const* a, float const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
 	{
-		if(d[i] != a[i] * b[i])
-		{
-			std::cerr << "Error in " << name << " " << d[i] << " != " << a[i] * b[i] << std::endl;
-			std::exit(1);
-		}
+		__m512 v1 = _mm512_load_ps(&a[i]);
+		__m512 v2 = _mm512_load_ps(&b[i]);
+		__m512 r = _mm512_mul_ps(v1, v2);
+		_mm512_stream_ps(&d[i], r);
 	}
 
-	std::cerr << name 
-			  << " (" << alignment << ") took " 
-			  << time << " seconds." 
-			  << std::endl
-	;
+	_mm_sfence();
 
-	std::cout << "," << time;
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
 }
 
-template<>
-void Run<NullMult>(char const*,  std::size_t, float*, float const*, float const*)
+// Full vectors, then one masked vector for whatever is left.
+SIMDPERF_TARGET("avx512f")
+void MaskedAvx512Mult(float* d, float const* a, float const* b, std::size_t n)
 {
-	std::cout << "," << 0;
-}
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m512 v1 = _mm512_loadu_ps(&a[i]);
+		__m512 v2 = _mm512_loadu_ps(&b[i]);
+		__m512 r = _mm512_mul_ps(v1, v2);
+		_mm512_storeu_ps(&d[i], r);
+	}
 
+	__mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+	__m512 v1 = _mm512_maskz_loadu_ps(tail, &a[i]);
+	__m512 v2 = _mm512_maskz_loadu_ps(tail, &b[i]);
+	__m512 r = _mm512_mul_ps(v1, v2);
+	_mm512_mask_storeu_ps(&d[i], tail, r);
+}
 
-// ----------------------------------------------------------------------------
-//
-void print_usage()
+// One plain loop compiled twice for AVX-512 hardware, with the
+// vectorizer preferring 512 or 256 bit vectors, to weigh the 512 bit
+// clock penalty against narrower code. SIMDPERF_VECTORIZE has them
+// vectorized at -O2 as well as -O3.
+SIMDPERF_TARGET("avx512f,avx512vl,prefer-vector-width=512")
+SIMDPERF_VECTORIZE
+void Vectorized512Mult(float* d, float const* a, float const* b, std::size_t n)
 {
-	std::cerr << "Usage:\n" 
-			  << "simd-mult [options]\n"
-			  << "num-floats=<number of float in memory>    default (" << kDefaultNumFloats << ")\n"
-			  << "total-floats=<number of floats total>     default (" << kDefaultTotalFloats << ")\n"
-			  << "check-value=<any value to check against>  default (" << gCheckValue << ")\n"
-			  << "enable-avx=<true/false>                   default (" << std::boolalpha << gHasAvx << ")\n"
-			  << "report-html=<true/false>                  default (" << std::boolalpha << gHtmlOut << ")\n"
-			  << std::endl;
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
 
+SIMDPERF_TARGET("avx512f,avx512vl,prefer-vector-width=256")
+SIMDPERF_VECTORIZE
+void Vectorized256Mult(float* d, float const* a, float const* b, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = a[i] * b[i];
 }
 
-// ----------------------------------------------------------------------------
-//
-int main(int argc, char** argv)
+// Tail strategies. The kernels above finish with a scalar epilogue;
+// these finish with one overlapping full vector ending at the last
+// element, or with an AVX maskload/maskstore pair.
+SIMDPERF_TARGET("sse2")
+void UnalignedSseOverlapMult(float* d, float const* a, float const* b, std::size_t n)
 {
-	cgutil::program_options opts;
-	opts.add("num-floats", gNumFloats);
-	opts.add("num-floats", gNumFloats);
-	opts.add("total-floats", gTotalFloats);
-	opts.add("check-value", gCheckValue);
-	opts.add("enable-avx", gHasAvx);
-	
-	try
+	if(n < 4)
 	{
-		opts.parse(argc, argv);
+		for(std::size_t i = 0; i < n; ++i)
+			d[i] = a[i] * b[i];
+		return;
 	}
-	catch(std::runtime_error e)
+
+	for(std::size_t i = 0; i + 4 <= n; i += 4)
 	{
-		std::cerr << e.what() << std::endl;
-		print_usage();
-		std::exit(1);
+		__m128 v1 = _mm_loadu_ps(&a[i]);
+		__m128 v2 = _mm_loadu_ps(&b[i]);
+		__m128 r = _mm_mul_ps(v1, v2);
+		_mm_storeu_ps(&d[i], r);
 	}
 
-	if(gTotalFloats < gNumFloats)
+	__m128 v1 = _mm_loadu_ps(&a[n - 4]);
+	__m128 v2 = _mm_loadu_ps(&b[n - 4]);
+	__m128 r = _mm_mul_ps(v1, v2);
+	_mm_storeu_ps(&d[n - 4], r);
+}
+
+SIMDPERF_TARGET("avx")
+void UnalignedAvxOverlapMult(float* d, float const* a, float const* b, std::size_t n)
+{
+	if(n < 8)
 	{
-		std::cerr << "total-floats must be greater than num-floats" << std::endl;
-		print_usage();
-		return 0;
+		for(std::size_t i = 0; i < n; ++i)
+			d[i] = a[i] * b[i];
+		return;
 	}
 
-	if(gHtmlOut)
+	for(std::size_t i = 0; i + 8 <= n; i += 8)
 	{
-		std::cout <<
-		   "<html>\n"
-		   "  <head>\n"
-		   "    <script type=\"text/javascript\" src=\"https://www.google.com/jsapi\"></script>\n"
-		   "    <script type=\"text/javascript\">\n"
-		   "      google.load(\"visualization\", \"1\", {packages:[\"corechart\"]});\n"
-		   "      google.setOnLoadCallback(drawChart);\n"
-		   "      function drawChart() {\n"
-		   "        var data = google.visualization.arrayToDataTable([\n"
-		;
+		__m256 v1 = _mm256_loadu_ps(&a[i]);
+		__m256 v2 = _mm256_loadu_ps(&b[i]);
+		__m256 r = _mm256_mul_ps(v1, v2);
+		_mm256_storeu_ps(&d[i], r);
 	}
 
-	// Allocate 64 megs worth of floats;
-	std::vector<float> source(gNumFloats + 0x1000, gCheckValue);
-	std::vector<float> dest(gNumFloats + 0x100, 0.f);
+	__m256 v1 = _mm256_loadu_ps(&a[n - 8]);
+	__m256 v2 = _mm256_loadu_ps(&b[n - 8]);
+	__m256 r = _mm256_mul_ps(v1, v2);
+	_mm256_storeu_ps(&d[n - 8], r);
+}
 
-	std::cout << "[\'Alignment\',\'for-loop\',\'Unaligned Sse\',\'Unaligned Avx\',\'Aligned Sse\',\'Aligned Sse Stream\',\'Aligned Avx\',\'Aligned Avx Stream\'";
-	for(std::size_t alignment = 4; alignment <= 64; ++alignment)
+SIMDPERF_TARGET("avx")
+void UnalignedAvxMaskedMult(float* d, float const* a, float const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
-		std::cout << "],\n" << "[" << alignment;
+		__m256 v1 = _mm256_loadu_ps(&a[i]);
+		__m256 v2 = _mm256_loadu_ps(&b[i]);
+		__m256 r = _mm256_mul_ps(v1, v2);
+		_mm256_storeu_ps(&d[i], r);
+	}
 
-		Run<NiaveMult>("for-loop", alignment, dest.data(), source.data(), source.data() + 256);
-		Run<UnalignedSseMult>("Unaligned Sse", alignment, dest.data(), source.data(), source.data() + 256);
+	__m256i tail = AvxTailMask(int(n - i));
+	__m256 v1 = _mm256_maskload_ps(&a[i], tail);
+	__m256 v2 = _mm256_maskload_ps(&b[i], tail);
+	__m256 r = _mm256_mul_ps(v1, v2);
+	_mm256_maskstore_ps(&d[i], tail, r);
+}
 
-	#if SUPPORT_AVX
-		if(gHasAvx)
+// Prefetching variants. Unrolled to one cache line per iteration with
+// one prefetch per input line, gPrefetchDistance bytes ahead of the
+// loads, or of the stores for prefetchw.
+template<int hint>
+SIMDPERF_TARGET("sse2")
+void PrefetchSseMult(float* d, float const* a, float const* b, std::size_t n)
+{
+	std::size_t const ahead = gPrefetchDistance / sizeof(float);
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		if(hint == kPrefetchW)
 		{
-			Run<UnalignedAvxMult>("Unaligned Avx", alignment, dest.data(), source.data(), source.data() + 256);
+			prefetch<hint>(&d[i + ahead]);
 		}
 		else
-	#endif
 		{
-			Run<NullMult>("Unaligned Avx", alignment, source.data(), source.data(), source.data() + 256);
+			prefetch<hint>(&a[i + ahead]);
+			prefetch<hint>(&b[i + ahead]);
 		}
 
-		if(alignment % 16 == 0)
-		{
-			Run<AlignedSseMult>("Aligned Sse", alignment, dest.data(), source.data(), source.data() + 256);
-			Run<AlignedSseNonTemporalMult>("Aligned Sse Stream", alignment, dest.data(), source.data(), source.data() + 256);
-		}
-		else
+		for(std::size_t j = 0; j < 16; j += 4)
 		{
-			Run<NullMult>("Aligned Sse", alignment, source.data(), source.data(), source.data() + 256);
-			Run<NullMult>("Aligned Sse Stream", alignment, source.data(), source.data(), source.data() + 256);
+			__m128 v1 = _mm_loadu_ps(&a[i + j]);
+			__m128 v2 = _mm_loadu_ps(&b[i + j]);
+			_mm_storeu_ps(&d[i + j], _mm_mul_ps(v1, v2));
 		}
-	#if SUPPORT_AVX
-		if(alignment % 32 == 0 && gHasAvx)
+	}
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
+
+template<int hint>
+SIMDPERF_TARGET("avx")
+void PrefetchAvxMult(float* d, float const* a, float const* b, std::size_t n)
+{
+	std::size_t const ahead = gPrefetchDistance / sizeof(float);
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		if(hint == kPrefetchW)
 		{
-			Run<AlignedAvxMult>("Aligned Avx", alignment, dest.data(), source.data(), source.data() + 256);
-			Run<AlignedAvxNonTemporalMult>("Aligned Avx Stream", alignment, dest.data(), source.data(), source.data() + 256);
+			prefetch<hint>(&d[i + ahead]);
 		}
 		else
-	#endif
 		{
-			Run<NullMult>("Aligned Avx", alignment, source.data(), source.data(), source.data() + 256);
-			Run<NullMult>("Aligned Avx Stream", alignment, source.data(), source.data(), source.data() + 256);
-		}       
+			prefetch<hint>(&a[i + ahead]);
+			prefetch<hint>(&b[i + ahead]);
+		}
+
+		__m256 r0 = _mm256_mul_ps(_mm256_loadu_ps(&a[i]), _mm256_loadu_ps(&b[i]));
+		__m256 r1 = _mm256_mul_ps(_mm256_loadu_ps(&a[i + 8]), _mm256_loadu_ps(&b[i + 8]));
+		_mm256_storeu_ps(&d[i], r0);
+		_mm256_storeu_ps(&d[i + 8], r1);
 	}
 
-	std::cout << "]" << std::endl;
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
 
-	if(gHtmlOut)
+// Generated kernels: unroll vectors per iteration held in independent
+// registers, loaded and stored with the given memory_flavor. A target
+// attribute cannot depend on a template argument, so each ISA has its
+// own copy of the loop around the shared vector ops.
+template<int unroll, int flavor>
+SIMDPERF_TARGET("sse2")
+void UnrolledSseMult(float* d, float const* a, float const* b, std::size_t n)
+{
+	typedef sse_ops V;
+	std::size_t const step = V::width * unroll;
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
+	{
+		V::type v[unroll];
+		for(int u = 0; u < unroll; ++u)
+			v[u] = V::mul(V::load<flavor>(&a[i + u * V::width]), V::load<flavor>(&b[i + u * V::width]));
+
+		for(int u = 0; u < unroll; ++u)
+			V::store<flavor>(&d[i + u * V::width], v[u]);
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
+
+template<int unroll, int flavor>
+SIMDPERF_TARGET("avx")
+void UnrolledAvxMult(float* d, float const* a, float const* b, std::size_t n)
+{
+	typedef avx_ops V;
+	std::size_t const step = V::width * unroll;
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
+	{
+		V::type v[unroll];
+		for(int u = 0; u < unroll; ++u)
+			v[u] = V::mul(V::load<flavor>(&a[i + u * V::width]), V::load<flavor>(&b[i + u * V::width]));
+
+		for(int u = 0; u < unroll; ++u)
+			V::store<flavor>(&d[i + u * V::width], v[u]);
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
+
+template<int unroll, int flavor>
+SIMDPERF_TARGET("avx512f")
+void UnrolledAvx512Mult(float* d, float const* a, float const* b, std::size_t n)
+{
+	typedef avx512_ops V;
+	std::size_t const step = V::width * unroll;
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
+	{
+		V::type v[unroll];
+		for(int u = 0; u < unroll; ++u)
+			v[u] = V::mul(V::load<flavor>(&a[i + u * V::width]), V::load<flavor>(&b[i + u * V::width]));
+
+		for(int u = 0; u < unroll; ++u)
+			V::store<flavor>(&d[i + u * V::width], v[u]);
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
+
+// d = a * b + c. The mul+add kernels round the product and the sum
+// separately; the Fma ones round once.
+void NiaveMulAdd(float* d, float const* a, float const* b, float const* c, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = a[i] * b[i] + c[i];
+}
+
+template<int flavor>
+SIMDPERF_TARGET("sse2")
+void SseMulAdd(float* d, float const* a, float const* b, float const* c, std::size_t n)
+{
+	typedef sse_ops V;
+	std::size_t i = 0;
+	for(; i + V::width <= n; i += V::width)
+	{
+		V::type va = V::load<flavor>(&a[i]);
+		V::type vb = V::load<flavor>(&b[i]);
+		V::type vc = V::load<flavor>(&c[i]);
+		V::store<flavor>(&d[i], V::add(V::mul(va, vb), vc));
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i] + c[i];
+}
+
+template<int flavor>
+SIMDPERF_TARGET("avx")
+void AvxMulAdd(float* d, float const* a, float const* b, float const* c, std::size_t n)
+{
+	typedef avx_ops V;
+	std::size_t i = 0;
+	for(; i + V::width <= n; i += V::width)
+	{
+		V::type va = V::load<flavor>(&a[i]);
+		V::type vb = V::load<flavor>(&b[i]);
+		V::type vc = V::load<flavor>(&c[i]);
+		V::store<flavor>(&d[i], V::add(V::mul(va, vb), vc));
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i] + c[i];
+}
+
+template<int flavor>
+SIMDPERF_TARGET("avx,fma")
+void AvxFma(float* d, float const* a, float const* b, float const* c, std::size_t n)
+{
+	typedef avx_ops V;
+	std::size_t i = 0;
+	for(; i + V::width <= n; i += V::width)
+	{
+		V::type va = V::load<flavor>(&a[i]);
+		V::type vb = V::load<flavor>(&b[i]);
+		V::type vc = V::load<flavor>(&c[i]);
+		V::store<flavor>(&d[i], V::fmadd(va, vb, vc));
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i] + c[i];
+}
+
+template<int flavor>
+SIMDPERF_TARGET("avx512f")
+void Avx512Fma(float* d, float const* a, float const* b, float const* c, std::size_t n)
+{
+	typedef avx512_ops V;
+	std::size_t i = 0;
+	for(; i + V::width <= n; i += V::width)
+	{
+		V::type va = V::load<flavor>(&a[i]);
+		V::type vb = V::load<flavor>(&b[i]);
+		V::type vc = V::load<flavor>(&c[i]);
+		V::store<flavor>(&d[i], V::fmadd(va, vb, vc));
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i] + c[i];
+}
+
+// Typed kernels for types mode. The for-loop is generic over the
+// element traits; each vector kernel needs its own multiply.
+template<typename E>
+void NiaveTypedMult(typename E::type* d, typename E::type const* a, typename E::type const* b, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = E::mul(a[i], b[i]);
+}
+
+SIMDPERF_TARGET("avx")
+void AvxDoubleMult(double* d, double const* a, double const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
+	{
+		__m256d v1 = _mm256_loadu_pd(&a[i]);
+		__m256d v2 = _mm256_loadu_pd(&b[i]);
+		_mm256_storeu_pd(&d[i], _mm256_mul_pd(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = a[i] * b[i];
+}
+
+SIMDPERF_TARGET("avx2")
+void Avx2Int32Mult(std::int32_t* d, std::int32_t const* a, std::int32_t const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&a[i]));
+		__m256i v2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&b[i]));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), _mm256_mullo_epi32(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = i32_element::mul(a[i], b[i]);
+}
+
+SIMDPERF_TARGET("avx2")
+void Avx2Int16Mult(std::int16_t* d, std::int16_t const* a, std::int16_t const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&a[i]));
+		__m256i v2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&b[i]));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), _mm256_mullo_epi16(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = i16_element::mul(a[i], b[i]);
+}
+
+// There is no byte multiply. The low byte of a 16 bit product only
+// depends on the low bytes of its inputs, so multiply the even bytes in
+// place and the odd bytes shifted down, then merge the low bytes.
+SIMDPERF_TARGET("avx2")
+void Avx2Int8Mult(std::int8_t* d, std::int8_t const* a, std::int8_t const* b, std::size_t n)
+{
+	__m256i const low_bytes = _mm256_set1_epi16(0xff);
+	std::size_t i = 0;
+	for(; i + 32 <= n; i += 32)
+	{
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&a[i]));
+		__m256i v2 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&b[i]));
+		__m256i even = _mm256_mullo_epi16(v1, v2);
+		__m256i odd = _mm256_mullo_epi16(_mm256_srli_epi16(v1, 8), _mm256_srli_epi16(v2, 8));
+		__m256i r = _mm256_or_si256(_mm256_and_si256(even, low_bytes), _mm256_slli_epi16(odd, 8));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), r);
+	}
+
+	for(; i < n; ++i)
+		d[i] = i8_element::mul(a[i], b[i]);
+}
+
+// Widens 8 halves to floats, multiplies, and rounds back to nearest.
+SIMDPERF_TARGET("avx,f16c")
+void F16cHalfMult(std::uint16_t* d, std::uint16_t const* a, std::uint16_t const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		__m256 v1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&a[i])));
+		__m256 v2 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&b[i])));
+		__m128i r = _mm256_cvtps_ph(_mm256_mul_ps(v1, v2), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i]), r);
+	}
+
+	for(; i < n; ++i)
+		d[i] = f16_element::mul(a[i], b[i]);
+}
+
+// Conversion fused kernels for convert mode: half or bf16 inputs are
+// widened to float, multiplied, and stored either as float or narrowed
+// back to the input type.
+SIMDPERF_TARGET("avx,f16c")
+void F16cHalfWidenMult(float* d, std::uint16_t const* a, std::uint16_t const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		__m256 v1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&a[i])));
+		__m256 v2 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&b[i])));
+		_mm256_storeu_ps(&d[i], _mm256_mul_ps(v1, v2));
+	}
+
+	for(; i < n; ++i)
+		d[i] = half_to_float(a[i]) * half_to_float(b[i]);
+}
+
+// bf16 is the top half of a float, so widening is a zero extend and a
+// shift.
+SIMDPERF_TARGET("avx2")
+inline __m256 Avx2WidenBf16(std::uint16_t const* p)
+{
+	__m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+	return _mm256_castsi256_ps(_mm256_slli_epi32(v, 16));
+}
+
+SIMDPERF_TARGET("avx2")
+void Avx2Bf16WidenMult(float* d, std::uint16_t const* a, std::uint16_t const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(&d[i], _mm256_mul_ps(Avx2WidenBf16(&a[i]), Avx2WidenBf16(&b[i])));
+
+	for(; i < n; ++i)
+		d[i] = bf16_to_float(a[i]) * bf16_to_float(b[i]);
+}
+
+// Narrows with the same round to nearest even as float_to_bf16, then
+// packs the 32 bit lanes down and gathers the two halves together.
+SIMDPERF_TARGET("avx2")
+void Avx2Bf16Mult(std::uint16_t* d, std::uint16_t const* a, std::uint16_t const* b, std::size_t n)
+{
+	__m256i const bias = _mm256_set1_epi32(0x7fff);
+	__m256i const one = _mm256_set1_epi32(1);
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8)
 	{
-		std::cout <<
-			"        ]);\n"
-			"        var options = {\n"
-			"          title: 'Alignment vs. Run Time'\n"
-			"        };\n"
-			"        var chart = new google.visualization.LineChart(document.getElementById('chart_div'));\n"
-			"        chart.draw(data, options);\n"
-			"      }\n"
-			"    </script>\n"
-			"  </head>\n"
-			"  <body>\n"
-			"    <div id=\"chart_div\" style=\"width: 900px; height: 500px;\"></div>\n"
-			"  </body>\n"
-			"</html>\n"
-		;
+		__m256i r = _mm256_castps_si256(_mm256_mul_ps(Avx2WidenBf16(&a[i]), Avx2WidenBf16(&b[i])));
+		__m256i odd = _mm256_and_si256(_mm256_srli_epi32(r, 16), one);
+		r = _mm256_srli_epi32(_mm256_add_epi32(r, _mm256_add_epi32(bias, odd)), 16);
+		r = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0x08);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i]), _mm256_castsi256_si128(r));
 	}
 
+	for(; i < n; ++i)
+		d[i] = bf16_element::mul(a[i], b[i]);
+}
+
+// vdpbf16ps sums the products of pairs of bf16s into a float. Zero
+// extending each input to 32 bits makes every pair (x, 0), so each lane
+// gets exactly one product, which is exact in float.
+SIMDPERF_TARGET("avx512f,avx512bf16")
+inline __m512 Avx512Bf16Product(std::uint16_t const* a, std::uint16_t const* b)
+{
+	// The zero masked form, because GCC 12 warns about the undefined
+	// source of the plain one.
+	__m512i v1 = _mm512_maskz_cvtepu16_epi32(0xffff, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a)));
+	__m512i v2 = _mm512_maskz_cvtepu16_epi32(0xffff, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b)));
+	return _mm512_dpbf16_ps(_mm512_setzero_ps(), (__m512bh)v1, (__m512bh)v2);
+}
+
+SIMDPERF_TARGET("avx512f,avx512bf16")
+void Avx512Bf16WidenMult(float* d, std::uint16_t const* a, std::uint16_t const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+		_mm512_storeu_ps(&d[i], Avx512Bf16Product(&a[i], &b[i]));
+
+	for(; i < n; ++i)
+		d[i] = bf16_to_float(a[i]) * bf16_to_float(b[i]);
+}
+
+SIMDPERF_TARGET("avx512f,avx512bf16")
+void Avx512Bf16Mult(std::uint16_t* d, std::uint16_t const* a, std::uint16_t const* b, std::size_t n)
+{
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m256bh r = _mm512_cvtneps_pbh(Avx512Bf16Product(&a[i], &b[i]));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), (__m256i)r);
+	}
+
+	for(; i < n; ++i)
+		d[i] = bf16_element::mul(a[i], b[i]);
+}
+
+// Reductions over a, and for the dot product b as well. Each keeps
+// accumulators independent partial results so consecutive adds do not
+// wait on each other, and combines them once at the end.
+enum reduce_op
+{
+	kReduceSum,
+	kReduceSumSquares,
+	kReduceDot,
+	kReduceMin,
+	kReduceMax,
+};
+
+inline float ReduceIdentity(int op)
+{
+	if(op == kReduceMin)
+		return std::numeric_limits<float>::infinity();
+	if(op == kReduceMax)
+		return -std::numeric_limits<float>::infinity();
+
+	return 0.f;
+}
+
+inline float ReduceStep(int op, float acc, float a, float b)
+{
+	switch(op)
+	{
+	case kReduceSumSquares: return acc + a * a;
+	case kReduceDot:        return acc + a * b;
+	case kReduceMin:        return std::min(acc, a);
+	case kReduceMax:        return std::max(acc, a);
+	}
+
+	return acc + a;
+}
+
+inline float ReduceCombine(int op, float x, float y)
+{
+	if(op == kReduceMin)
+		return std::min(x, y);
+	if(op == kReduceMax)
+		return std::max(x, y);
+
+	return x + y;
+}
+
+template<int op, int accumulators>
+float ReduceScalar(float const* a, float const* b, std::size_t n)
+{
+	float acc[accumulators];
+	for(int u = 0; u < accumulators; ++u)
+		acc[u] = ReduceIdentity(op);
+
+	std::size_t i = 0;
+	for(; i + accumulators <= n; i += accumulators)
+	{
+		for(int u = 0; u < accumulators; ++u)
+			acc[u] = ReduceStep(op, acc[u], a[i + u], b[i + u]);
+	}
+
+	for(int u = 1; u < accumulators; ++u)
+		acc[0] = ReduceCombine(op, acc[0], acc[u]);
+
+	for(; i < n; ++i)
+		acc[0] = ReduceStep(op, acc[0], a[i], b[i]);
+
+	return acc[0];
+}
+
+template<int op, int accumulators>
+SIMDPERF_TARGET("sse2")
+float ReduceSse(float const* a, float const* b, std::size_t n)
+{
+	typedef sse_ops V;
+	std::size_t const step = V::width * accumulators;
+	V::type acc[accumulators];
+	for(int u = 0; u < accumulators; ++u)
+		acc[u] = V::set1(ReduceIdentity(op));
+
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
+	{
+		for(int u = 0; u < accumulators; ++u)
+		{
+			V::type va = V::load<kUnaligned>(&a[i + u * V::width]);
+			if(op == kReduceDot)
+				acc[u] = V::add(acc[u], V::mul(va, V::load<kUnaligned>(&b[i + u * V::width])));
+			else if(op == kReduceSumSquares)
+				acc[u] = V::add(acc[u], V::mul(va, va));
+			else if(op == kReduceMin)
+				acc[u] = V::min(acc[u], va);
+			else if(op == kReduceMax)
+				acc[u] = V::max(acc[u], va);
+			else
+				acc[u] = V::add(acc[u], va);
+		}
+	}
+
+	for(int u = 1; u < accumulators; ++u)
+		acc[0] = op == kReduceMin ? V::min(acc[0], acc[u]) : op == kReduceMax ? V::max(acc[0], acc[u]) : V::add(acc[0], acc[u]);
+
+	float lanes[V::width];
+	V::store<kUnaligned>(lanes, acc[0]);
+	float r = lanes[0];
+	for(int l = 1; l < V::width; ++l)
+		r = ReduceCombine(op, r, lanes[l]);
+
+	for(; i < n; ++i)
+		r = ReduceStep(op, r, a[i], b[i]);
+
+	return r;
+}
+
+template<int op, int accumulators>
+SIMDPERF_TARGET("avx")
+float ReduceAvx(float const* a, float const* b, std::size_t n)
+{
+	typedef avx_ops V;
+	std::size_t const step = V::width * accumulators;
+	V::type acc[accumulators];
+	for(int u = 0; u < accumulators; ++u)
+		acc[u] = V::set1(ReduceIdentity(op));
+
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
+	{
+		for(int u = 0; u < accumulators; ++u)
+		{
+			V::type va = V::load<kUnaligned>(&a[i + u * V::width]);
+			if(op == kReduceDot)
+				acc[u] = V::add(acc[u], V::mul(va, V::load<kUnaligned>(&b[i + u * V::width])));
+			else if(op == kReduceSumSquares)
+				acc[u] = V::add(acc[u], V::mul(va, va));
+			else if(op == kReduceMin)
+				acc[u] = V::min(acc[u], va);
+			else if(op == kReduceMax)
+				acc[u] = V::max(acc[u], va);
+			else
+				acc[u] = V::add(acc[u], va);
+		}
+	}
+
+	for(int u = 1; u < accumulators; ++u)
+		acc[0] = op == kReduceMin ? V::min(acc[0], acc[u]) : op == kReduceMax ? V::max(acc[0], acc[u]) : V::add(acc[0], acc[u]);
+
+	float lanes[V::width];
+	V::store<kUnaligned>(lanes, acc[0]);
+	float r = lanes[0];
+	for(int l = 1; l < V::width; ++l)
+		r = ReduceCombine(op, r, lanes[l]);
+
+	for(; i < n; ++i)
+		r = ReduceStep(op, r, a[i], b[i]);
+
+	return r;
+}
+
+// As ReduceAvx, with the multiply and add of the dot product and sum of
+// squares fused.
+template<int op, int accumulators>
+SIMDPERF_TARGET("avx,fma")
+float ReduceFma(float const* a, float const* b, std::size_t n)
+{
+	typedef avx_ops V;
+	std::size_t const step = V::width * accumulators;
+	V::type acc[accumulators];
+	for(int u = 0; u < accumulators; ++u)
+		acc[u] = V::set1(ReduceIdentity(op));
+
+	std::size_t i = 0;
+	for(; i + step <= n; i += step)
+	{
+		for(int u = 0; u < accumulators; ++u)
+		{
+			V::type va = V::load<kUnaligned>(&a[i + u * V::width]);
+			if(op == kReduceDot)
+				acc[u] = V::fmadd(va, V::load<kUnaligned>(&b[i + u * V::width]), acc[u]);
+			else if(op == kReduceSumSquares)
+				acc[u] = V::fmadd(va, va, acc[u]);
+			else if(op == kReduceMin)
+				acc[u] = V::min(acc[u], va);
+			else if(op == kReduceMax)
+				acc[u] = V::max(acc[u], va);
+			else
+				acc[u] = V::add(acc[u], va);
+		}
+	}
+
+	for(int u = 1; u < accumulators; ++u)
+		acc[0] = op == kReduceMin ? V::min(acc[0], acc[u]) : op == kReduceMax ? V::max(acc[0], acc[u]) : V::add(acc[0], acc[u]);
+
+	float lanes[V::width];
+	V::store<kUnaligned>(lanes, acc[0]);
+	float r = lanes[0];
+	for(int l = 1; l < V::width; ++l)
+		r = ReduceCombine(op, r, lanes[l]);
+
+	for(; i < n; ++i)
+		r = ReduceStep(op, r, a[i], b[i]);
+
+	return r;
+}
+
+// The STREAM kernels, d = op(a, b): Copy d = a, Scale d = q * a,
+// Add d = a + b and Triad d = a + q * b, with STREAM's q of 3.
+enum stream_op
+{
+	kStreamCopy,
+	kStreamScale,
+	kStreamAdd,
+	kStreamTriad,
+};
+
+float const kStreamScalar = 3.f;
+
+inline char const* StreamOpName(int op)
+{
+	switch(op)
+	{
+	case kStreamCopy:  return "Copy";
+	case kStreamScale: return "Scale";
+	case kStreamAdd:   return "Add";
+	case kStreamTriad: return "Triad";
+	}
+
+	return "unknown";
+}
+
+// Array accesses per element as STREAM counts them: reads plus the
+// write, with no allowance for the write allocate.
+inline std::size_t StreamWordsPerFloat(int op)
+{
+	return op == kStreamAdd || op == kStreamTriad ? 3 : 2;
+}
+
+inline float StreamElement(int op, float a, float b)
+{
+	switch(op)
+	{
+	case kStreamScale: return kStreamScalar * a;
+	case kStreamAdd:   return a + b;
+	case kStreamTriad: return a + kStreamScalar * b;
+	}
+
+	return a;
+}
+
+template<int op>
+void StreamScalar(float* d, float const* a, float const* b, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		d[i] = StreamElement(op, a[i], b[i]);
+}
+
+template<int op, int flavor>
+SIMDPERF_TARGET("sse2")
+void StreamSse(float* d, float const* a, float const* b, std::size_t n)
+{
+	typedef sse_ops V;
+	V::type const q = V::set1(kStreamScalar);
+	std::size_t i = 0;
+	for(; i + V::width <= n; i += V::width)
+	{
+		V::type v = V::load<flavor>(&a[i]);
+		if(op == kStreamScale)
+			v = V::mul(q, v);
+		else if(op == kStreamAdd)
+			v = V::add(v, V::load<flavor>(&b[i]));
+		else if(op == kStreamTriad)
+			v = V::add(v, V::mul(q, V::load<flavor>(&b[i])));
+
+		V::store<flavor>(&d[i], v);
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = StreamElement(op, a[i], b[i]);
+}
+
+template<int op, int flavor>
+SIMDPERF_TARGET("avx")
+void StreamAvx(float* d, float const* a, float const* b, std::size_t n)
+{
+	typedef avx_ops V;
+	V::type const q = V::set1(kStreamScalar);
+	std::size_t i = 0;
+	for(; i + V::width <= n; i += V::width)
+	{
+		V::type v = V::load<flavor>(&a[i]);
+		if(op == kStreamScale)
+			v = V::mul(q, v);
+		else if(op == kStreamAdd)
+			v = V::add(v, V::load<flavor>(&b[i]));
+		else if(op == kStreamTriad)
+			v = V::add(v, V::mul(q, V::load<flavor>(&b[i])));
+
+		V::store<flavor>(&d[i], v);
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = StreamElement(op, a[i], b[i]);
+}
+
+template<int op, int flavor>
+SIMDPERF_TARGET("avx512f")
+void StreamAvx512(float* d, float const* a, float const* b, std::size_t n)
+{
+	typedef avx512_ops V;
+	V::type const q = V::set1(kStreamScalar);
+	std::size_t i = 0;
+	for(; i + V::width <= n; i += V::width)
+	{
+		V::type v = V::load<flavor>(&a[i]);
+		if(op == kStreamScale)
+			v = V::mul(q, v);
+		else if(op == kStreamAdd)
+			v = V::add(v, V::load<flavor>(&b[i]));
+		else if(op == kStreamTriad)
+			v = V::add(v, V::mul(q, V::load<flavor>(&b[i])));
+
+		V::store<flavor>(&d[i], v);
+	}
+
+	if(flavor == kStream)
+		_mm_sfence();
+
+	for(; i < n; ++i)
+		d[i] = StreamElement(op, a[i], b[i]);
+}
+
+// ----------------------------------------------------------------------------
+//
+double CyclesPerFloat(trial_stats const& stats)
+{
+	return seconds_to_cycles(stats.median) / gTotalFloats;
+}
+
+double GigabytesPerSecond(trial_stats const& stats, std::size_t streams = kStreamsPerFloat)
+{
+	if(stats.median <= 0)
+		return 0;
+
+	return double(streams) * sizeof(float) * gTotalFloats / stats.median / 1e9;
+}
+
+double ChartValue(trial_stats const& stats)
+{
+	return gReportCycles ? CyclesPerFloat(stats) : stats.median;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Checks the kernel output and that nothing was written into the guard
+// floats past the end.
+void CheckResult(char const* name, float const* d, float const* a, float const* b)
+{
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		if(d[i] != a[i] * b[i])
+		{
+			std::cerr << "Error in " << name << " " << d[i] << " != " << a[i] * b[i] << std::endl;
+			std::exit(1);
+		}
+	}
+
+	for(std::size_t i = gNumFloats; i < gNumFloats + kGuardFloats; ++i)
+	{
+		if(d[i] != 0.f)
+		{
+			std::cerr << "Error in " << name << " wrote past the end at " << i << std::endl;
+			std::exit(1);
+		}
+	}
+}
+
+template<void(*f)(float*, float const*, float const*, std::size_t)>
+trial_stats Run(char const* name, placement const& dp, placement const& ap, placement const& bp, float* d, float const* a, float const* b)
+{
+	d = place(d, dp);
+	a = place(a, ap);
+	b = place(b, bp);
+	std::fill(d, d + gNumFloats + kGuardFloats, 0.f);
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			f(d, a, b, gNumFloats);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	CheckResult(name, d, a, b);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_float = CyclesPerFloat(stats);
+	double bytes_per_cycle = kStreamsPerFloat * sizeof(float) / cycles_per_float;
+	std::cerr << name 
+			  << " (dst " << dp << ", a " << ap << ", b " << bp << ") seconds: " 
+			  << stats
+			  << " cycles/float " << cycles_per_float
+			  << " bytes/cycle " << bytes_per_cycle
+			  << std::endl
+	;
+
+	if(gCounters.available())
+	{
+		cgutil::timer t;
+		perf_sample counted = gCounters.count(pass);
+		double seconds = t.elapsed();
+		std::cerr << "    ";
+		print_perf_sample(std::cerr, counted, double(kStreamsPerFloat) * sizeof(float) * gTotalFloats, seconds);
+		std::cerr << std::endl;
+	}
+
+	return stats;
+}
+
+// Runs f with the buffers split across every member of team, each member
+// working its own chunk as many times as Run would work the whole
+// buffer, so the stats are comparable with Run.
+template<void(*f)(float*, float const*, float const*, std::size_t)>
+trial_stats RunParallel(char const* name, thread_team& team, placement const& dp, placement const& ap, placement const& bp, float* d, float const* a, float const* b)
+{
+	d = place(d, dp);
+	a = place(a, ap);
+	b = place(b, bp);
+	std::fill(d, d + gNumFloats + kGuardFloats, 0.f);
+
+	// Chunks start on cache lines so the aligned kernels stay aligned and
+	// no two members share a line.
+	std::size_t const granule = kCacheLineBytes / sizeof(float);
+	std::function<void(std::size_t)> job = [&](std::size_t index)
+	{
+		std::size_t begin, end;
+		partition(gNumFloats, team.size(), granule, index, begin, end);
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			f(d + begin, a + begin, b + begin, end - begin);
+		}
+	};
+
+	auto pass = [&]
+	{
+		team.run(job);
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+	CheckResult(name, d, a, b);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	std::cerr << name 
+			  << " (" << team.size() << " threads, dst " << dp << ", a " << ap << ", b " << bp << ") seconds: " 
+			  << stats
+			  << " GB/s " << GigabytesPerSecond(stats)
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Setup and kernel time for single passes into a fresh destination.
+struct cold_stats
+{
+	trial_stats setup;
+	trial_stats run;
+};
+
+// Runs f once per trial into a destination mapped just before it, so
+// the kernel takes every page fault unless policy already took them in
+// the setup: the mmap plus any populate or prefault work. Unmapping the
+// previous trial's destination is not timed.
+template<void(*f)(float*, float const*, float const*, std::size_t)>
+cold_stats RunCold(char const* name, fault_policy policy, thread_team& team, placement const& dp, placement const& ap, placement const& bp, float const* a, float const* b)
+{
+	a = place(a, ap);
+	b = place(b, bp);
+	std::size_t const bytes = (gNumFloats + placement_padding(dp) / sizeof(float)) * sizeof(float);
+	std::unique_ptr<page_buffer> pages;
+	float* d = nullptr;
+
+	std::function<void(std::size_t)> prefault = [&](std::size_t index)
+	{
+		std::size_t const page_bytes = page_kind_bytes(pages->kind());
+		std::size_t begin, end;
+		partition(pages->size(), team.size(), page_bytes, index, begin, end);
+		touch_pages(pages->data<char>() + begin, end - begin, page_bytes);
+	};
+
+	auto setup = [&]
+	{
+		pages.reset(new page_buffer(bytes, gPageKind, policy == fault_policy::populate));
+		if(!pages->data<float>())
+			return;
+
+		if(policy == fault_policy::prefault)
+			team.run(prefault);
+		else if(policy == fault_policy::warm)
+			touch_pages(pages->data<float>(), pages->size(), page_kind_bytes(pages->kind()));
+	};
+
+	auto pass = [&]
+	{
+		f(d, a, b, gNumFloats);
+	};
+
+	std::vector<double> setup_samples;
+	std::vector<double> run_samples;
+	for(std::size_t i = 0; i < gWarmupTrials + gTrials; ++i)
+	{
+		double setup_seconds = 0;
+		if(!pages || policy != fault_policy::warm)
+		{
+			pages.reset();
+			setup_seconds = time_call(gTimingBackend, setup);
+			if(!pages->data<float>())
+			{
+				std::cerr << "failed to map " << format_bytes(bytes) << " of " << page_kind_name(gPageKind) << " pages" << std::endl;
+				std::exit(1);
+			}
+
+			d = place(pages->data<float>(), dp);
+		}
+
+		// A warm destination is only set up once, so it has no setup
+		// cost per pass.
+		if(policy == fault_policy::warm)
+			setup_seconds = 0;
+
+		double run_seconds = time_call(gTimingBackend, pass);
+		if(i >= gWarmupTrials)
+		{
+			setup_samples.push_back(setup_seconds);
+			run_samples.push_back(run_seconds);
+		}
+	}
+
+	CheckResult(name, d, a, b);
+
+	cold_stats stats;
+	stats.setup = summarise(setup_samples, gBootstrapResamples, gConfidence);
+	stats.run = summarise(run_samples, gBootstrapResamples, gConfidence);
+	std::cerr << name << " (" << fault_policy_name(policy) << ", dst " << dp << ", a " << ap << ", b " << bp << ")"
+			  << " setup seconds: " << stats.setup.median
+			  << " run seconds: " << stats.run
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Accepts either rounding of a * b + c: the mul+add kernels round
+// twice, the Fma kernels once, and the compiler may contract the scalar
+// loops either way.
+void CheckFmaResult(char const* name, float const* d, float const* a, float const* b, float const* c)
+{
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		float const product = a[i] * b[i];
+		float const unfused = product + c[i];
+		float const fused = std::fma(a[i], b[i], c[i]);
+		if(d[i] != unfused && d[i] != fused)
+		{
+			std::cerr << "Error in " << name << " " << d[i] << " != " << fused << std::endl;
+			std::exit(1);
+		}
+	}
+
+	for(std::size_t i = gNumFloats; i < gNumFloats + kGuardFloats; ++i)
+	{
+		if(d[i] != 0.f)
+		{
+			std::cerr << "Error in " << name << " wrote past the end at " << i << std::endl;
+			std::exit(1);
+		}
+	}
+}
+
+// Run for the d = a * b + c kernels. The three inputs share the source
+// placement.
+template<void(*f)(float*, float const*, float const*, float const*, std::size_t)>
+trial_stats RunFma(char const* name, placement const& dp, placement const& sp, float* d, float const* a, float const* b, float const* c)
+{
+	d = place(d, dp);
+	a = place(a, sp);
+	b = place(b, sp);
+	c = place(c, sp);
+	std::fill(d, d + gNumFloats + kGuardFloats, 0.f);
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			f(d, a, b, c, gNumFloats);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	CheckFmaResult(name, d, a, b, c);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_float = CyclesPerFloat(stats);
+	std::cerr << name 
+			  << " (dst " << dp << ", src " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/float " << cycles_per_float
+			  << " flops/cycle " << 2 / cycles_per_float
+			  << " bytes/cycle " << kFmaStreamsPerFloat * sizeof(float) / cycles_per_float
+			  << std::endl
+	;
+
+	if(gCounters.available())
+	{
+		cgutil::timer t;
+		perf_sample counted = gCounters.count(pass);
+		double seconds = t.elapsed();
+		std::cerr << "    ";
+		print_perf_sample(std::cerr, counted, double(kFmaStreamsPerFloat) * sizeof(float) * gTotalFloats, seconds);
+		std::cerr << std::endl;
+	}
+
+	return stats;
+}
+
+// Checks a reduction against a double precision reference. The kernels
+// add in different orders, so sums only have to agree to within the
+// float error bound for n additions, n * eps * the sum of the absolute
+// terms; min and max have to match exactly.
+void CheckReduceResult(char const* name, int op, float result, float const* a, float const* b)
+{
+	double expected = ReduceIdentity(op);
+	double magnitude = 0;
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		double term = a[i];
+		if(op == kReduceSumSquares)
+			term = double(a[i]) * a[i];
+		else if(op == kReduceDot)
+			term = double(a[i]) * b[i];
+
+		if(op == kReduceMin)
+			expected = std::min<double>(expected, a[i]);
+		else if(op == kReduceMax)
+			expected = std::max<double>(expected, a[i]);
+		else
+			expected += term;
+
+		magnitude += std::abs(term);
+	}
+
+	double const eps = std::numeric_limits<float>::epsilon();
+	double const tolerance = (op == kReduceMin || op == kReduceMax) ? 0 : gNumFloats * eps * magnitude;
+	if(std::abs(result - expected) > tolerance)
+	{
+		std::cerr << "Error in " << name << " " << result << " != " << expected << std::endl;
+		std::exit(1);
+	}
+}
+
+template<int op, float(*f)(float const*, float const*, std::size_t)>
+trial_stats RunReduce(char const* name, placement const& sp, float const* a, float const* b)
+{
+	a = place(a, sp);
+	b = place(b, sp);
+
+	// Read back every call so the compiler cannot hoist a pure reduction
+	// out of the pass.
+	float const* volatile input = a;
+	float result = 0;
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			result = f(input, b, gNumFloats);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	CheckReduceResult(name, op, result, a, b);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_float = CyclesPerFloat(stats);
+	std::cerr << name 
+			  << " (src " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/float " << cycles_per_float
+			  << " floats/cycle " << 1 / cycles_per_float
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Triad may be computed fused or unfused, as in CheckFmaResult.
+void CheckStreamResult(char const* name, int op, float const* d, float const* a, float const* b)
+{
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		float const expected = StreamElement(op, a[i], b[i]);
+		bool const fused = op == kStreamTriad && d[i] == std::fma(kStreamScalar, b[i], a[i]);
+		if(d[i] != expected && !fused)
+		{
+			std::cerr << "Error in " << name << " " << d[i] << " != " << expected << std::endl;
+			std::exit(1);
+		}
+	}
+
+	for(std::size_t i = gNumFloats; i < gNumFloats + kGuardFloats; ++i)
+	{
+		if(d[i] != 0.f)
+		{
+			std::cerr << "Error in " << name << " wrote past the end at " << i << std::endl;
+			std::exit(1);
+		}
+	}
+}
+
+// Runs f over the whole arrays once per trial, split across team as
+// RunParallel splits them, and prints a line in STREAM's format: the
+// best rate comes from the fastest trial, in MB/s of 10^6 bytes.
+template<int op, void(*f)(float*, float const*, float const*, std::size_t)>
+trial_stats RunStream(char const* name, thread_team& team, placement const& dp, placement const& sp, float* d, float const* a, float const* b)
+{
+	d = place(d, dp);
+	a = place(a, sp);
+	b = place(b, sp);
+
+	std::size_t const granule = kCacheLineBytes / sizeof(float);
+	std::function<void(std::size_t)> job = [&](std::size_t index)
+	{
+		std::size_t begin, end;
+		partition(gNumFloats, team.size(), granule, index, begin, end);
+		f(d + begin, a + begin, b + begin, end - begin);
+	};
+
+	auto pass = [&]
+	{
+		team.run(job);
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+	CheckStreamResult(name, op, d, a, b);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double const bytes = double(StreamWordsPerFloat(op)) * sizeof(float) * gNumFloats;
+	double const max = *std::max_element(samples.begin(), samples.end());
+	char line[128];
+	std::snprintf(line, sizeof(line), "%-26s%14.1f  %11.6f  %11.6f  %11.6f",
+				  name, stats.min > 0 ? bytes / stats.min / 1e6 : 0., stats.mean, stats.min, max);
+	std::cerr << line << std::endl;
+
+	return stats;
+}
+
+// Checks a typed kernel against the scalar product of its element
+// traits and that nothing was written into the guard elements.
+template<typename E>
+void CheckTypedResult(char const* name, typename E::type const* d, typename E::type const* a, typename E::type const* b, std::size_t n, std::size_t guard)
+{
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		if(d[i] != E::mul(a[i], b[i]))
+		{
+			std::cerr << "Error in " << name << " " << E::to_double(d[i]) << " != " << E::to_double(E::mul(a[i], b[i])) << std::endl;
+			std::exit(1);
+		}
+	}
+
+	for(std::size_t i = n; i < n + guard; ++i)
+	{
+		if(d[i] != 0)
+		{
+			std::cerr << "Error in " << name << " wrote past the end at " << i << std::endl;
+			std::exit(1);
+		}
+	}
+}
+
+// Run for the typed kernels. num-floats and total-floats are taken as
+// byte counts in floats, so every element type moves the same bytes
+// and GigabytesPerSecond applies unchanged. The inputs are filled with
+// check-value plus position dependent values converted to the element
+// type, so a kernel that reorders lanes fails validation.
+template<typename E, void(*f)(typename E::type*, typename E::type const*, typename E::type const*, std::size_t)>
+trial_stats RunTyped(char const* name, placement const& dp, placement const& sp, void* d_memory, void* a_memory, void* b_memory)
+{
+	typedef typename E::type T;
+	std::size_t const n = gNumFloats * sizeof(float) / sizeof(T);
+	std::size_t const total = gTotalFloats * sizeof(float) / sizeof(T);
+	std::size_t const guard = kCacheLineBytes / sizeof(T);
+	T* d = place(static_cast<T*>(d_memory), dp);
+	T* a = place(static_cast<T*>(a_memory), sp);
+	T* b = place(static_cast<T*>(b_memory), sp);
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		a[i] = E::from_float(gCheckValue + float(i & 0xff));
+		b[i] = E::from_float(gCheckValue + float((3 * i) & 0x7f));
+	}
+	std::fill(d, d + n + guard, T(0));
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < total; i += n)
+		{
+			f(d, a, b, n);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	CheckTypedResult<E>(name, d, a, b, n, guard);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_element = seconds_to_cycles(stats.median) / total;
+	std::cerr << name 
+			  << " (dst " << dp << ", a " << sp << ", b " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/element " << cycles_per_element
+			  << " bytes/cycle " << kStreamsPerFloat * sizeof(T) / cycles_per_element
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Run for the convert kernels: In inputs, Out output. Unlike RunTyped
+// every kernel works on num-floats elements, so narrower inputs move
+// fewer bytes and the kernels compare on elements per second. The
+// inputs vary with position, as in RunTyped, and the expected product
+// is taken in float and converted to Out.
+template<typename In, typename Out, void(*f)(typename Out::type*, typename In::type const*, typename In::type const*, std::size_t)>
+trial_stats RunConvert(char const* name, placement const& dp, placement const& sp, void* d_memory, void* a_memory, void* b_memory)
+{
+	typedef typename In::type T;
+	typedef typename Out::type U;
+	U* d = place(static_cast<U*>(d_memory), dp);
+	T* a = place(static_cast<T*>(a_memory), sp);
+	T* b = place(static_cast<T*>(b_memory), sp);
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		a[i] = In::from_float(gCheckValue + float(i & 0xff));
+		b[i] = In::from_float(gCheckValue + float((3 * i) & 0x7f));
+	}
+	std::fill(d, d + gNumFloats + kGuardFloats, U(0));
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			f(d, a, b, gNumFloats);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	// Compared as values: the bf16 dot product instructions accumulate
+	// onto +0, so a -0 product comes back as +0.
+	for(std::size_t i = 0; i < gNumFloats + kGuardFloats; ++i)
+	{
+		U const expected = i < gNumFloats ? Out::from_float(float(In::to_double(a[i])) * float(In::to_double(b[i]))) : U(0);
+		if(Out::to_double(d[i]) != Out::to_double(expected))
+		{
+			std::cerr << "Error in " << name << " at " << i << " " << Out::to_double(d[i]) << " != " << Out::to_double(expected) << std::endl;
+			std::exit(1);
+		}
+	}
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_float = CyclesPerFloat(stats);
+	std::cerr << name 
+			  << " (dst " << dp << ", a " << sp << ", b " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/element " << cycles_per_float
+			  << " bytes/cycle " << (2 * sizeof(T) + sizeof(U)) / cycles_per_float
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// Checks every element a strided or indexed kernel wrote, and that it
+// wrote nothing else up to the guard floats past the furthest element
+// it may write.
+void CheckIndexedResult(char const* name, int pattern, float const* d, float const* a, float const* b, std::int32_t const* index)
+{
+	for(std::size_t i = 0; i < gNumFloats; ++i)
+	{
+		float const expected = pattern == kStrided ? a[i * gStride] * b[i * gStride] : pattern == kGather ? a[index[i]] * b[index[i]] : a[i] * b[i];
+		float const actual = pattern == kScatter ? d[index[i]] : d[i];
+		if(actual != expected)
+		{
+			std::cerr << "Error in " << name << " " << actual << " != " << expected << std::endl;
+			std::exit(1);
+		}
+	}
+
+	std::size_t const span = gNumFloats * gStride;
+	std::size_t const written = pattern == kScatter ? span : gNumFloats;
+	for(std::size_t j = 0; j < written + kGuardFloats; ++j)
+	{
+		bool const target = pattern == kScatter ? j < span && j % gStride == 0 : j < gNumFloats;
+		if(!target && d[j] != 0.f)
+		{
+			std::cerr << "Error in " << name << " wrote outside its elements at " << j << std::endl;
+			std::exit(1);
+		}
+	}
+}
+
+// Run for the stride mode kernels. Bytes and cycles count only the
+// floats the kernel uses, not the lines it has to move to get them.
+template<int pattern, void(*f)(float*, float const*, float const*, std::int32_t const*, std::size_t)>
+trial_stats RunIndexed(char const* name, placement const& dp, placement const& sp, float* d, float const* a, float const* b, std::int32_t const* index)
+{
+	d = place(d, dp);
+	a = place(a, sp);
+	b = place(b, sp);
+	std::fill(d, d + (pattern == kScatter ? gNumFloats * gStride : gNumFloats) + kGuardFloats, 0.f);
+
+	auto pass = [&]
+	{
+		for(std::size_t i = 0; i < gTotalFloats; i += gNumFloats)
+		{
+			f(d, a, b, index, gNumFloats);
+		}
+	};
+
+	std::vector<double> samples = run_trials(gTimingBackend, gWarmupTrials, gTrials, pass);
+
+	CheckIndexedResult(name, pattern, d, a, b, index);
+
+	trial_stats stats = summarise(samples, gBootstrapResamples, gConfidence);
+	double cycles_per_float = CyclesPerFloat(stats);
+	std::cerr << name 
+			  << " (stride " << gStride << ", dst " << dp << ", a " << sp << ", b " << sp << ") seconds: " 
+			  << stats
+			  << " cycles/float " << cycles_per_float
+			  << " bytes/cycle " << kStreamsPerFloat * sizeof(float) / cycles_per_float
+			  << std::endl
+	;
+
+	return stats;
+}
+
+// ----------------------------------------------------------------------------
+//
+typedef trial_stats (*RunFn)(char const*, placement const&, placement const&, placement const&, float*, float const*, float const*);
+typedef trial_stats (*RunParallelFn)(char const*, thread_team&, placement const&, placement const&, placement const&, float*, float const*, float const*);
+typedef cold_stats (*RunColdFn)(char const*, fault_policy, thread_team&, placement const&, placement const&, placement const&, float const*, float const*);
+typedef trial_stats (*RunFmaFn)(char const*, placement const&, placement const&, float*, float const*, float const*, float const*);
+typedef trial_stats (*RunReduceFn)(char const*, placement const&, float const*, float const*);
+typedef trial_stats (*RunStreamFn)(char const*, thread_team&, placement const&, placement const&, float*, float const*, float const*);
+typedef trial_stats (*RunTypedFn)(char const*, placement const&, placement const&, void*, void*, void*);
+typedef trial_stats (*RunConvertFn)(char const*, placement const&, placement const&, void*, void*, void*);
+typedef trial_stats (*RunIndexedFn)(char const*, placement const&, placement const&, float*, float const*, float const*, std::int32_t const*);
+
+struct Kernel
+{
+	char const* name;
+	RunFn run;
+	RunParallelFn run_parallel;
+	RunColdFn run_cold;
+	std::size_t alignment; // required, in bytes
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+Kernel const kKernels[] =
+{
+	{ "for-loop",              &Run<NiaveMult>,                    &RunParallel<NiaveMult>,                    &RunCold<NiaveMult>,                    1,  0                          },
+	{ "Unaligned Sse",         &Run<UnalignedSseMult>,             &RunParallel<UnalignedSseMult>,             &RunCold<UnalignedSseMult>,             1,  kCpuSse2                   },
+	{ "Unaligned Avx",         &Run<UnalignedAvxMult>,             &RunParallel<UnalignedAvxMult>,             &RunCold<UnalignedAvxMult>,             1,  kCpuAvx                    },
+	{ "Aligned Sse",           &Run<AlignedSseMult>,               &RunParallel<AlignedSseMult>,               &RunCold<AlignedSseMult>,               16, kCpuSse2                   },
+	{ "Aligned Sse Stream",    &Run<AlignedSseNonTemporalMult>,    &RunParallel<AlignedSseNonTemporalMult>,    &RunCold<AlignedSseNonTemporalMult>,    16, kCpuSse2                   },
+	{ "Aligned Avx",           &Run<AlignedAvxMult>,               &RunParallel<AlignedAvxMult>,               &RunCold<AlignedAvxMult>,               32, kCpuAvx                    },
+	{ "Aligned Avx Stream",    &Run<AlignedAvxNonTemporalMult>,    &RunParallel<AlignedAvxNonTemporalMult>,    &RunCold<AlignedAvxNonTemporalMult>,    32, kCpuAvx                    },
+	{ "Unaligned Avx512",      &Run<UnalignedAvx512Mult>,          &RunParallel<UnalignedAvx512Mult>,          &RunCold<UnalignedAvx512Mult>,          1,  kCpuAvx512f                },
+	{ "Aligned Avx512",        &Run<AlignedAvx512Mult>,            &RunParallel<AlignedAvx512Mult>,            &RunCold<AlignedAvx512Mult>,            64, kCpuAvx512f                },
+	{ "Aligned Avx512 Stream", &Run<AlignedAvx512NonTemporalMult>, &RunParallel<AlignedAvx512NonTemporalMult>, &RunCold<AlignedAvx512NonTemporalMult>, 64, kCpuAvx512f                },
+	{ "Masked Avx512",         &Run<MaskedAvx512Mult>,             &RunParallel<MaskedAvx512Mult>,             &RunCold<MaskedAvx512Mult>,             1,  kCpuAvx512f                },
+	{ "Vectorized Avx512 512", &Run<Vectorized512Mult>,            &RunParallel<Vectorized512Mult>,            &RunCold<Vectorized512Mult>,            1,  kCpuAvx512f | kCpuAvx512vl },
+	{ "Vectorized Avx512 256", &Run<Vectorized256Mult>,            &RunParallel<Vectorized256Mult>,            &RunCold<Vectorized256Mult>,            1,  kCpuAvx512f | kCpuAvx512vl },
+	{ "Unaligned Sse Overlap", &Run<UnalignedSseOverlapMult>,      &RunParallel<UnalignedSseOverlapMult>,      &RunCold<UnalignedSseOverlapMult>,      1,  kCpuSse2                   },
+	{ "Unaligned Avx Overlap", &Run<UnalignedAvxOverlapMult>,      &RunParallel<UnalignedAvxOverlapMult>,      &RunCold<UnalignedAvxOverlapMult>,      1,  kCpuAvx                    },
+	{ "Unaligned Avx Masked",  &Run<UnalignedAvxMaskedMult>,       &RunParallel<UnalignedAvxMaskedMult>,       &RunCold<UnalignedAvxMaskedMult>,       1,  kCpuAvx                    },
+};
+
+// The prefetching variants only run in prefetch mode, each against the
+// same loop instantiated without prefetches.
+struct PrefetchKernel
+{
+	char const* name;
+	RunFn run;
+	RunFn baseline;
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+PrefetchKernel const kPrefetchKernels[] =
+{
+	{ "Prefetch Sse T0",  &Run<PrefetchSseMult<kPrefetchT0>>,  &Run<PrefetchSseMult<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse T1",  &Run<PrefetchSseMult<kPrefetchT1>>,  &Run<PrefetchSseMult<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse T2",  &Run<PrefetchSseMult<kPrefetchT2>>,  &Run<PrefetchSseMult<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse NTA", &Run<PrefetchSseMult<kPrefetchNta>>, &Run<PrefetchSseMult<kPrefetchNone>>, kCpuSse2              },
+	{ "Prefetch Sse W",   &Run<PrefetchSseMult<kPrefetchW>>,   &Run<PrefetchSseMult<kPrefetchNone>>, kCpuSse2 | kCpuPrfchw },
+	{ "Prefetch Avx T0",  &Run<PrefetchAvxMult<kPrefetchT0>>,  &Run<PrefetchAvxMult<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx T1",  &Run<PrefetchAvxMult<kPrefetchT1>>,  &Run<PrefetchAvxMult<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx T2",  &Run<PrefetchAvxMult<kPrefetchT2>>,  &Run<PrefetchAvxMult<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx NTA", &Run<PrefetchAvxMult<kPrefetchNta>>, &Run<PrefetchAvxMult<kPrefetchNone>>, kCpuAvx               },
+	{ "Prefetch Avx W",   &Run<PrefetchAvxMult<kPrefetchW>>,   &Run<PrefetchAvxMult<kPrefetchNone>>, kCpuAvx | kCpuPrfchw  },
+};
+
+// Generated kernels for the unroll sweep. Each family is one ISA and
+// memory flavor at every unroll depth.
+struct UnrolledKernel
+{
+	char const* family;
+	int unroll;
+	RunFn run;
+	std::size_t alignment; // required, in bytes
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+UnrolledKernel const kUnrolledKernels[] =
+{
+	{ "Sse Unaligned",    1, &Run<UnrolledSseMult<1, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Unaligned",    2, &Run<UnrolledSseMult<2, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Unaligned",    4, &Run<UnrolledSseMult<4, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Unaligned",    8, &Run<UnrolledSseMult<8, kUnaligned>>,    1,  kCpuSse2    },
+	{ "Sse Aligned",      1, &Run<UnrolledSseMult<1, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Aligned",      2, &Run<UnrolledSseMult<2, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Aligned",      4, &Run<UnrolledSseMult<4, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Aligned",      8, &Run<UnrolledSseMult<8, kAligned>>,      16, kCpuSse2    },
+	{ "Sse Stream",       1, &Run<UnrolledSseMult<1, kStream>>,       16, kCpuSse2    },
+	{ "Sse Stream",       2, &Run<UnrolledSseMult<2, kStream>>,       16, kCpuSse2    },
+	{ "Sse Stream",       4, &Run<UnrolledSseMult<4, kStream>>,       16, kCpuSse2    },
+	{ "Sse Stream",       8, &Run<UnrolledSseMult<8, kStream>>,       16, kCpuSse2    },
+	{ "Avx Unaligned",    1, &Run<UnrolledAvxMult<1, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Unaligned",    2, &Run<UnrolledAvxMult<2, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Unaligned",    4, &Run<UnrolledAvxMult<4, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Unaligned",    8, &Run<UnrolledAvxMult<8, kUnaligned>>,    1,  kCpuAvx     },
+	{ "Avx Aligned",      1, &Run<UnrolledAvxMult<1, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Aligned",      2, &Run<UnrolledAvxMult<2, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Aligned",      4, &Run<UnrolledAvxMult<4, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Aligned",      8, &Run<UnrolledAvxMult<8, kAligned>>,      32, kCpuAvx     },
+	{ "Avx Stream",       1, &Run<UnrolledAvxMult<1, kStream>>,       32, kCpuAvx     },
+	{ "Avx Stream",       2, &Run<UnrolledAvxMult<2, kStream>>,       32, kCpuAvx     },
+	{ "Avx Stream",       4, &Run<UnrolledAvxMult<4, kStream>>,       32, kCpuAvx     },
+	{ "Avx Stream",       8, &Run<UnrolledAvxMult<8, kStream>>,       32, kCpuAvx     },
+	{ "Avx512 Unaligned", 1, &Run<UnrolledAvx512Mult<1, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Unaligned", 2, &Run<UnrolledAvx512Mult<2, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Unaligned", 4, &Run<UnrolledAvx512Mult<4, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Unaligned", 8, &Run<UnrolledAvx512Mult<8, kUnaligned>>, 1,  kCpuAvx512f },
+	{ "Avx512 Aligned",   1, &Run<UnrolledAvx512Mult<1, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Aligned",   2, &Run<UnrolledAvx512Mult<2, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Aligned",   4, &Run<UnrolledAvx512Mult<4, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Aligned",   8, &Run<UnrolledAvx512Mult<8, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512 Stream",    1, &Run<UnrolledAvx512Mult<1, kStream>>,    64, kCpuAvx512f },
+	{ "Avx512 Stream",    2, &Run<UnrolledAvx512Mult<2, kStream>>,    64, kCpuAvx512f },
+	{ "Avx512 Stream",    4, &Run<UnrolledAvx512Mult<4, kStream>>,    64, kCpuAvx512f },
+	{ "Avx512 Stream",    8, &Run<UnrolledAvx512Mult<8, kStream>>,    64, kCpuAvx512f },
+};
+
+// The d = a * b + c kernels for fma mode. They read three streams, so
+// they take their own Run rather than sharing kKernels.
+struct FmaKernel
+{
+	char const* name;
+	RunFmaFn run;
+	std::size_t alignment; // required, in bytes
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+FmaKernel const kFmaKernels[] =
+{
+	{ "for-loop",              &RunFma<NiaveMulAdd>,           1,  0                 },
+	{ "Sse Mul+Add Unaligned", &RunFma<SseMulAdd<kUnaligned>>, 1,  kCpuSse2          },
+	{ "Sse Mul+Add Aligned",   &RunFma<SseMulAdd<kAligned>>,   16, kCpuSse2          },
+	{ "Sse Mul+Add Stream",    &RunFma<SseMulAdd<kStream>>,    16, kCpuSse2          },
+	{ "Avx Mul+Add Unaligned", &RunFma<AvxMulAdd<kUnaligned>>, 1,  kCpuAvx           },
+	{ "Avx Mul+Add Aligned",   &RunFma<AvxMulAdd<kAligned>>,   32, kCpuAvx           },
+	{ "Avx Mul+Add Stream",    &RunFma<AvxMulAdd<kStream>>,    32, kCpuAvx           },
+	{ "Fma3 Unaligned",        &RunFma<AvxFma<kUnaligned>>,    1,  kCpuAvx | kCpuFma },
+	{ "Fma3 Aligned",          &RunFma<AvxFma<kAligned>>,      32, kCpuAvx | kCpuFma },
+	{ "Fma3 Stream",           &RunFma<AvxFma<kStream>>,       32, kCpuAvx | kCpuFma },
+	{ "Avx512 Fma Unaligned",  &RunFma<Avx512Fma<kUnaligned>>, 1,  kCpuAvx512f       },
+	{ "Avx512 Fma Aligned",    &RunFma<Avx512Fma<kAligned>>,   64, kCpuAvx512f       },
+	{ "Avx512 Fma Stream",     &RunFma<Avx512Fma<kStream>>,    64, kCpuAvx512f       },
+};
+
+// Reduction kernels for reduce mode. Each family is one operation and
+// ISA at every accumulator count.
+struct ReduceKernel
+{
+	char const* family;
+	int accumulators;
+	RunReduceFn run;
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+ReduceKernel const kReduceKernels[] =
+{
+	{ "Scalar Sum",            1, &RunReduce<kReduceSum, ReduceScalar<kReduceSum, 1>>,               0                 },
+	{ "Scalar Sum",            2, &RunReduce<kReduceSum, ReduceScalar<kReduceSum, 2>>,               0                 },
+	{ "Scalar Sum",            4, &RunReduce<kReduceSum, ReduceScalar<kReduceSum, 4>>,               0                 },
+	{ "Scalar Sum",            8, &RunReduce<kReduceSum, ReduceScalar<kReduceSum, 8>>,               0                 },
+	{ "Sse Sum",               1, &RunReduce<kReduceSum, ReduceSse<kReduceSum, 1>>,                  kCpuSse2          },
+	{ "Sse Sum",               2, &RunReduce<kReduceSum, ReduceSse<kReduceSum, 2>>,                  kCpuSse2          },
+	{ "Sse Sum",               4, &RunReduce<kReduceSum, ReduceSse<kReduceSum, 4>>,                  kCpuSse2          },
+	{ "Sse Sum",               8, &RunReduce<kReduceSum, ReduceSse<kReduceSum, 8>>,                  kCpuSse2          },
+	{ "Avx Sum",               1, &RunReduce<kReduceSum, ReduceAvx<kReduceSum, 1>>,                  kCpuAvx           },
+	{ "Avx Sum",               2, &RunReduce<kReduceSum, ReduceAvx<kReduceSum, 2>>,                  kCpuAvx           },
+	{ "Avx Sum",               4, &RunReduce<kReduceSum, ReduceAvx<kReduceSum, 4>>,                  kCpuAvx           },
+	{ "Avx Sum",               8, &RunReduce<kReduceSum, ReduceAvx<kReduceSum, 8>>,                  kCpuAvx           },
+	{ "Scalar Sum of Squares", 1, &RunReduce<kReduceSumSquares, ReduceScalar<kReduceSumSquares, 1>>, 0                 },
+	{ "Scalar Sum of Squares", 2, &RunReduce<kReduceSumSquares, ReduceScalar<kReduceSumSquares, 2>>, 0                 },
+	{ "Scalar Sum of Squares", 4, &RunReduce<kReduceSumSquares, ReduceScalar<kReduceSumSquares, 4>>, 0                 },
+	{ "Scalar Sum of Squares", 8, &RunReduce<kReduceSumSquares, ReduceScalar<kReduceSumSquares, 8>>, 0                 },
+	{ "Sse Sum of Squares",    1, &RunReduce<kReduceSumSquares, ReduceSse<kReduceSumSquares, 1>>,    kCpuSse2          },
+	{ "Sse Sum of Squares",    2, &RunReduce<kReduceSumSquares, ReduceSse<kReduceSumSquares, 2>>,    kCpuSse2          },
+	{ "Sse Sum of Squares",    4, &RunReduce<kReduceSumSquares, ReduceSse<kReduceSumSquares, 4>>,    kCpuSse2          },
+	{ "Sse Sum of Squares",    8, &RunReduce<kReduceSumSquares, ReduceSse<kReduceSumSquares, 8>>,    kCpuSse2          },
+	{ "Avx Sum of Squares",    1, &RunReduce<kReduceSumSquares, ReduceAvx<kReduceSumSquares, 1>>,    kCpuAvx           },
+	{ "Avx Sum of Squares",    2, &RunReduce<kReduceSumSquares, ReduceAvx<kReduceSumSquares, 2>>,    kCpuAvx           },
+	{ "Avx Sum of Squares",    4, &RunReduce<kReduceSumSquares, ReduceAvx<kReduceSumSquares, 4>>,    kCpuAvx           },
+	{ "Avx Sum of Squares",    8, &RunReduce<kReduceSumSquares, ReduceAvx<kReduceSumSquares, 8>>,    kCpuAvx           },
+	{ "Fma Sum of Squares",    1, &RunReduce<kReduceSumSquares, ReduceFma<kReduceSumSquares, 1>>,    kCpuAvx | kCpuFma },
+	{ "Fma Sum of Squares",    2, &RunReduce<kReduceSumSquares, ReduceFma<kReduceSumSquares, 2>>,    kCpuAvx | kCpuFma },
+	{ "Fma Sum of Squares",    4, &RunReduce<kReduceSumSquares, ReduceFma<kReduceSumSquares, 4>>,    kCpuAvx | kCpuFma },
+	{ "Fma Sum of Squares",    8, &RunReduce<kReduceSumSquares, ReduceFma<kReduceSumSquares, 8>>,    kCpuAvx | kCpuFma },
+	{ "Scalar Dot",            1, &RunReduce<kReduceDot, ReduceScalar<kReduceDot, 1>>,               0                 },
+	{ "Scalar Dot",            2, &RunReduce<kReduceDot, ReduceScalar<kReduceDot, 2>>,               0                 },
+	{ "Scalar Dot",            4, &RunReduce<kReduceDot, ReduceScalar<kReduceDot, 4>>,               0                 },
+	{ "Scalar Dot",            8, &RunReduce<kReduceDot, ReduceScalar<kReduceDot, 8>>,               0                 },
+	{ "Sse Dot",               1, &RunReduce<kReduceDot, ReduceSse<kReduceDot, 1>>,                  kCpuSse2          },
+	{ "Sse Dot",               2, &RunReduce<kReduceDot, ReduceSse<kReduceDot, 2>>,                  kCpuSse2          },
+	{ "Sse Dot",               4, &RunReduce<kReduceDot, ReduceSse<kReduceDot, 4>>,                  kCpuSse2          },
+	{ "Sse Dot",               8, &RunReduce<kReduceDot, ReduceSse<kReduceDot, 8>>,                  kCpuSse2          },
+	{ "Avx Dot",               1, &RunReduce<kReduceDot, ReduceAvx<kReduceDot, 1>>,                  kCpuAvx           },
+	{ "Avx Dot",               2, &RunReduce<kReduceDot, ReduceAvx<kReduceDot, 2>>,                  kCpuAvx           },
+	{ "Avx Dot",               4, &RunReduce<kReduceDot, ReduceAvx<kReduceDot, 4>>,                  kCpuAvx           },
+	{ "Avx Dot",               8, &RunReduce<kReduceDot, ReduceAvx<kReduceDot, 8>>,                  kCpuAvx           },
+	{ "Fma Dot",               1, &RunReduce<kReduceDot, ReduceFma<kReduceDot, 1>>,                  kCpuAvx | kCpuFma },
+	{ "Fma Dot",               2, &RunReduce<kReduceDot, ReduceFma<kReduceDot, 2>>,                  kCpuAvx | kCpuFma },
+	{ "Fma Dot",               4, &RunReduce<kReduceDot, ReduceFma<kReduceDot, 4>>,                  kCpuAvx | kCpuFma },
+	{ "Fma Dot",               8, &RunReduce<kReduceDot, ReduceFma<kReduceDot, 8>>,                  kCpuAvx | kCpuFma },
+	{ "Scalar Min",            1, &RunReduce<kReduceMin, ReduceScalar<kReduceMin, 1>>,               0                 },
+	{ "Scalar Min",            2, &RunReduce<kReduceMin, ReduceScalar<kReduceMin, 2>>,               0                 },
+	{ "Scalar Min",            4, &RunReduce<kReduceMin, ReduceScalar<kReduceMin, 4>>,               0                 },
+	{ "Scalar Min",            8, &RunReduce<kReduceMin, ReduceScalar<kReduceMin, 8>>,               0                 },
+	{ "Sse Min",               1, &RunReduce<kReduceMin, ReduceSse<kReduceMin, 1>>,                  kCpuSse2          },
+	{ "Sse Min",               2, &RunReduce<kReduceMin, ReduceSse<kReduceMin, 2>>,                  kCpuSse2          },
+	{ "Sse Min",               4, &RunReduce<kReduceMin, ReduceSse<kReduceMin, 4>>,                  kCpuSse2          },
+	{ "Sse Min",               8, &RunReduce<kReduceMin, ReduceSse<kReduceMin, 8>>,                  kCpuSse2          },
+	{ "Avx Min",               1, &RunReduce<kReduceMin, ReduceAvx<kReduceMin, 1>>,                  kCpuAvx           },
+	{ "Avx Min",               2, &RunReduce<kReduceMin, ReduceAvx<kReduceMin, 2>>,                  kCpuAvx           },
+	{ "Avx Min",               4, &RunReduce<kReduceMin, ReduceAvx<kReduceMin, 4>>,                  kCpuAvx           },
+	{ "Avx Min",               8, &RunReduce<kReduceMin, ReduceAvx<kReduceMin, 8>>,                  kCpuAvx           },
+	{ "Scalar Max",            1, &RunReduce<kReduceMax, ReduceScalar<kReduceMax, 1>>,               0                 },
+	{ "Scalar Max",            2, &RunReduce<kReduceMax, ReduceScalar<kReduceMax, 2>>,               0                 },
+	{ "Scalar Max",            4, &RunReduce<kReduceMax, ReduceScalar<kReduceMax, 4>>,               0                 },
+	{ "Scalar Max",            8, &RunReduce<kReduceMax, ReduceScalar<kReduceMax, 8>>,               0                 },
+	{ "Sse Max",               1, &RunReduce<kReduceMax, ReduceSse<kReduceMax, 1>>,                  kCpuSse2          },
+	{ "Sse Max",               2, &RunReduce<kReduceMax, ReduceSse<kReduceMax, 2>>,                  kCpuSse2          },
+	{ "Sse Max",               4, &RunReduce<kReduceMax, ReduceSse<kReduceMax, 4>>,                  kCpuSse2          },
+	{ "Sse Max",               8, &RunReduce<kReduceMax, ReduceSse<kReduceMax, 8>>,                  kCpuSse2          },
+	{ "Avx Max",               1, &RunReduce<kReduceMax, ReduceAvx<kReduceMax, 1>>,                  kCpuAvx           },
+	{ "Avx Max",               2, &RunReduce<kReduceMax, ReduceAvx<kReduceMax, 2>>,                  kCpuAvx           },
+	{ "Avx Max",               4, &RunReduce<kReduceMax, ReduceAvx<kReduceMax, 4>>,                  kCpuAvx           },
+	{ "Avx Max",               8, &RunReduce<kReduceMax, ReduceAvx<kReduceMax, 8>>,                  kCpuAvx           },
+};
+
+// The STREAM suite for stream mode, one family per ISA and store
+// flavor.
+struct StreamKernel
+{
+	char const* family;
+	int op;
+	RunStreamFn run;
+	std::size_t alignment; // required, in bytes
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+StreamKernel const kStreamKernels[] =
+{
+	{ "for-loop",      kStreamCopy,  &RunStream<kStreamCopy, StreamScalar<kStreamCopy>>,             1,  0           },
+	{ "for-loop",      kStreamScale, &RunStream<kStreamScale, StreamScalar<kStreamScale>>,           1,  0           },
+	{ "for-loop",      kStreamAdd,   &RunStream<kStreamAdd, StreamScalar<kStreamAdd>>,               1,  0           },
+	{ "for-loop",      kStreamTriad, &RunStream<kStreamTriad, StreamScalar<kStreamTriad>>,           1,  0           },
+	{ "Sse",           kStreamCopy,  &RunStream<kStreamCopy, StreamSse<kStreamCopy, kAligned>>,      16, kCpuSse2    },
+	{ "Sse",           kStreamScale, &RunStream<kStreamScale, StreamSse<kStreamScale, kAligned>>,    16, kCpuSse2    },
+	{ "Sse",           kStreamAdd,   &RunStream<kStreamAdd, StreamSse<kStreamAdd, kAligned>>,        16, kCpuSse2    },
+	{ "Sse",           kStreamTriad, &RunStream<kStreamTriad, StreamSse<kStreamTriad, kAligned>>,    16, kCpuSse2    },
+	{ "Sse Stream",    kStreamCopy,  &RunStream<kStreamCopy, StreamSse<kStreamCopy, kStream>>,       16, kCpuSse2    },
+	{ "Sse Stream",    kStreamScale, &RunStream<kStreamScale, StreamSse<kStreamScale, kStream>>,     16, kCpuSse2    },
+	{ "Sse Stream",    kStreamAdd,   &RunStream<kStreamAdd, StreamSse<kStreamAdd, kStream>>,         16, kCpuSse2    },
+	{ "Sse Stream",    kStreamTriad, &RunStream<kStreamTriad, StreamSse<kStreamTriad, kStream>>,     16, kCpuSse2    },
+	{ "Avx",           kStreamCopy,  &RunStream<kStreamCopy, StreamAvx<kStreamCopy, kAligned>>,      32, kCpuAvx     },
+	{ "Avx",           kStreamScale, &RunStream<kStreamScale, StreamAvx<kStreamScale, kAligned>>,    32, kCpuAvx     },
+	{ "Avx",           kStreamAdd,   &RunStream<kStreamAdd, StreamAvx<kStreamAdd, kAligned>>,        32, kCpuAvx     },
+	{ "Avx",           kStreamTriad, &RunStream<kStreamTriad, StreamAvx<kStreamTriad, kAligned>>,    32, kCpuAvx     },
+	{ "Avx Stream",    kStreamCopy,  &RunStream<kStreamCopy, StreamAvx<kStreamCopy, kStream>>,       32, kCpuAvx     },
+	{ "Avx Stream",    kStreamScale, &RunStream<kStreamScale, StreamAvx<kStreamScale, kStream>>,     32, kCpuAvx     },
+	{ "Avx Stream",    kStreamAdd,   &RunStream<kStreamAdd, StreamAvx<kStreamAdd, kStream>>,         32, kCpuAvx     },
+	{ "Avx Stream",    kStreamTriad, &RunStream<kStreamTriad, StreamAvx<kStreamTriad, kStream>>,     32, kCpuAvx     },
+	{ "Avx512",        kStreamCopy,  &RunStream<kStreamCopy, StreamAvx512<kStreamCopy, kAligned>>,   64, kCpuAvx512f },
+	{ "Avx512",        kStreamScale, &RunStream<kStreamScale, StreamAvx512<kStreamScale, kAligned>>, 64, kCpuAvx512f },
+	{ "Avx512",        kStreamAdd,   &RunStream<kStreamAdd, StreamAvx512<kStreamAdd, kAligned>>,     64, kCpuAvx512f },
+	{ "Avx512",        kStreamTriad, &RunStream<kStreamTriad, StreamAvx512<kStreamTriad, kAligned>>, 64, kCpuAvx512f },
+	{ "Avx512 Stream", kStreamCopy,  &RunStream<kStreamCopy, StreamAvx512<kStreamCopy, kStream>>,    64, kCpuAvx512f },
+	{ "Avx512 Stream", kStreamScale, &RunStream<kStreamScale, StreamAvx512<kStreamScale, kStream>>,  64, kCpuAvx512f },
+	{ "Avx512 Stream", kStreamAdd,   &RunStream<kStreamAdd, StreamAvx512<kStreamAdd, kStream>>,      64, kCpuAvx512f },
+	{ "Avx512 Stream", kStreamTriad, &RunStream<kStreamTriad, StreamAvx512<kStreamTriad, kStream>>,  64, kCpuAvx512f },
+};
+
+// Kernels for types mode: a for-loop and a vector kernel per element
+// type.
+struct TypedKernel
+{
+	char const* name;
+	char const* type;
+	RunTypedFn run;
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+TypedKernel const kTypedKernels[] =
+{
+	{ "for-loop", "float",  &RunTyped<f32_element, NiaveTypedMult<f32_element>>, 0                  },
+	{ "for-loop", "double", &RunTyped<f64_element, NiaveTypedMult<f64_element>>, 0                  },
+	{ "for-loop", "int32",  &RunTyped<i32_element, NiaveTypedMult<i32_element>>, 0                  },
+	{ "for-loop", "int16",  &RunTyped<i16_element, NiaveTypedMult<i16_element>>, 0                  },
+	{ "for-loop", "int8",   &RunTyped<i8_element, NiaveTypedMult<i8_element>>,   0                  },
+	{ "for-loop", "half",   &RunTyped<f16_element, NiaveTypedMult<f16_element>>, kCpuF16c           },
+	{ "Avx",      "float",  &RunTyped<f32_element, UnalignedAvxMult>,            kCpuAvx            },
+	{ "Avx",      "double", &RunTyped<f64_element, AvxDoubleMult>,               kCpuAvx            },
+	{ "Avx2",     "int32",  &RunTyped<i32_element, Avx2Int32Mult>,               kCpuAvx2           },
+	{ "Avx2",     "int16",  &RunTyped<i16_element, Avx2Int16Mult>,               kCpuAvx2           },
+	{ "Avx2",     "int8",   &RunTyped<i8_element, Avx2Int8Mult>,                 kCpuAvx2           },
+	{ "F16c",     "half",   &RunTyped<f16_element, F16cHalfMult>,                kCpuAvx | kCpuF16c },
+};
+
+// Kernels for convert mode. The first is the float baseline the others
+// are compared with.
+struct ConvertKernel
+{
+	char const* name;
+	RunConvertFn run;
+	std::size_t alignment; // required, in bytes
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+ConvertKernel const kConvertKernels[] =
+{
+	{ "Aligned Avx float",        &RunConvert<f32_element, f32_element, AlignedAvxMult>,       32, kCpuAvx                      },
+	{ "F16c half to float",       &RunConvert<f16_element, f32_element, F16cHalfWidenMult>,    1,  kCpuAvx | kCpuF16c           },
+	{ "F16c half",                &RunConvert<f16_element, f16_element, F16cHalfMult>,         1,  kCpuAvx | kCpuF16c           },
+	{ "Avx2 bf16 to float",       &RunConvert<bf16_element, f32_element, Avx2Bf16WidenMult>,   1,  kCpuAvx2                     },
+	{ "Avx2 bf16",                &RunConvert<bf16_element, bf16_element, Avx2Bf16Mult>,       1,  kCpuAvx2                     },
+	{ "Avx512bf16 bf16 to float", &RunConvert<bf16_element, f32_element, Avx512Bf16WidenMult>, 1,  kCpuAvx512f | kCpuAvx512bf16 },
+	{ "Avx512bf16 bf16",          &RunConvert<bf16_element, bf16_element, Avx512Bf16Mult>,     1,  kCpuAvx512f | kCpuAvx512bf16 },
+};
+
+// Kernels for stride mode. None needs aligned buffers.
+struct IndexedKernel
+{
+	char const* name;
+	RunIndexedFn run;
+	unsigned isa; // cpu_feature mask the kernel needs
+};
+
+IndexedKernel const kIndexedKernels[] =
+{
+	{ "for-loop Strided", &RunIndexed<kStrided, NiaveStridedMult>,  0           },
+	{ "Avx2 Strided",     &RunIndexed<kStrided, Avx2StridedMult>,   kCpuAvx2    },
+	{ "Avx512 Strided",   &RunIndexed<kStrided, Avx512StridedMult>, kCpuAvx512f },
+	{ "for-loop Gather",  &RunIndexed<kGather, NiaveGatherMult>,    0           },
+	{ "Avx2 Gather",      &RunIndexed<kGather, Avx2GatherMult>,     kCpuAvx2    },
+	{ "Avx512 Gather",    &RunIndexed<kGather, Avx512GatherMult>,   kCpuAvx512f },
+	{ "for-loop Scatter", &RunIndexed<kScatter, NiaveScatterMult>,  0           },
+	{ "Avx512 Scatter",   &RunIndexed<kScatter, Avx512ScatterMult>, kCpuAvx512f },
+};
+
+bool CanRun(Kernel const& kernel, placement const& dp, placement const& sp)
+{
+	return (kernel.isa & gCpuFeatures) == kernel.isa && is_aligned(dp, kernel.alignment) && is_aligned(sp, kernel.alignment);
+}
+
+void PrintColumns(char const* first)
+{
+	std::cout << "[\'" << first << "\'";
+	for(Kernel const& kernel : kKernels)
+		std::cout << ",\'" << kernel.name << "\'";
+}
+
+// Fills a page buffer with value. Fails the run if it could not be
+// mapped.
+float* FillPages(page_buffer const& pages, float value)
+{
+	float* p = pages.data<float>();
+	if(!p)
+	{
+		std::cerr << "failed to map " << format_bytes(pages.size()) << " of " << page_kind_name(pages.kind()) << " pages" << std::endl;
+		std::exit(1);
+	}
+
+	std::fill(p, p + pages.size() / sizeof(float), value);
+	return p;
+}
+
+// Floats from the start of a's region of a source buffer to the start
+// of b's. Each source is placed inside its own region, so a and b stay
+// two streams however large the base; the extra 1 KiB keeps them apart
+// modulo 4 KiB when the base is smaller than a page.
+std::size_t SourceRegionFloats(std::size_t num_floats, placement const& sp)
+{
+	std::size_t const floats = num_floats + placement_padding(sp) / sizeof(float);
+	return ((floats + 0x3ff) & ~std::size_t(0x3ff)) + 256;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Moves source and destination together through every float offset
+// from their base alignment.
+void RunAlignmentSweep()
+{
+	std::size_t const max_offset = 64;
+	placement dp(gDestPlacement.base, max_offset);
+	placement sp(gSourcePlacement.base, max_offset);
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, sp);
+	std::vector<float> source(2 * b_offset, gCheckValue);
+	std::vector<float> dest(gNumFloats + placement_padding(dp) / sizeof(float), 0.f);
+
+	PrintColumns("Offset");
+	for(std::size_t offset = 0; offset <= max_offset; offset += sizeof(float))
+	{
+		dp.offset = offset;
+		sp.offset = offset;
+		std::cout << "],\n" << "[" << offset;
+		for(Kernel const& kernel : kKernels)
+		{
+			trial_stats stats;
+			if(CanRun(kernel, dp, sp))
+				stats = kernel.run(kernel.name, dp, sp, sp, dest.data(), source.data(), source.data() + b_offset);
+
+			std::cout << "," << ChartValue(stats);
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Moves source and destination offsets independently and renders one
+// throughput heatmap per kernel, so split line loads and split line
+// stores show up as separate bands.
+void RunHeatmap()
+{
+	std::size_t const max_offset = 64;
+	placement dp(gDestPlacement.base, max_offset);
+	placement sp(gSourcePlacement.base, max_offset);
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, sp);
+	std::vector<float> source(2 * b_offset, gCheckValue);
+	std::vector<float> dest(gNumFloats + placement_padding(dp) / sizeof(float), 0.f);
+
+	std::vector<std::size_t> offsets;
+	for(std::size_t offset = 0; offset < max_offset; offset += sizeof(float))
+		offsets.push_back(offset);
+
+	for(Kernel const& kernel : kKernels)
+	{
+		std::vector<double> cells(offsets.size() * offsets.size());
+		for(std::size_t s = 0; s < offsets.size(); ++s)
+		{
+			sp.offset = offsets[s];
+			for(std::size_t d = 0; d < offsets.size(); ++d)
+			{
+				dp.offset = offsets[d];
+				if(CanRun(kernel, dp, sp))
+				{
+					trial_stats stats = kernel.run(kernel.name, dp, sp, sp, dest.data(), source.data(), source.data() + b_offset);
+					cells[s * offsets.size() + d] = GigabytesPerSecond(stats);
+				}
+			}
+		}
+
+		if(gHtmlOut)
+		{
+			heatmap_table(std::cout, kernel.name, "src", "dst", offsets, offsets, cells);
+		}
+		else
+		{
+			std::cout << kernel.name << "\n";
+			for(std::size_t s = 0; s < offsets.size(); ++s)
+			{
+				std::cout << offsets[s];
+				for(std::size_t d = 0; d < offsets.size(); ++d)
+					std::cout << "," << cells[s * offsets.size() + d];
+				std::cout << "\n";
+			}
+		}
+	}
+}
+
+// Sweeps the distances from a to b and from a to d modulo 4 KiB, one
+// at a time with the other held half a page away, with all three
+// buffers in their own page based regions. Distances whose bandwidth
+// falls well below the kernel's median are flagged as aliasing cliffs.
+void RunAliasingSweep()
+{
+	std::vector<std::size_t> distances = aliasing_distances(kPageBytes, gAliasStep, gAliasWindow, sizeof(float));
+	std::size_t const fixed = kPageBytes / 2;
+	std::size_t const region = gNumFloats + placement_padding(placement(kPageBytes, kPageBytes)) / sizeof(float);
+	std::vector<float> source(2 * region, gCheckValue);
+	std::vector<float> dest(region, 0.f);
+	float const* a_region = source.data();
+	float const* b_region = source.data() + region;
+	placement const ap(kPageBytes, 0);
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> b_bandwidth(num_kernels, std::vector<double>(distances.size()));
+	std::vector<std::vector<double>> d_bandwidth(num_kernels, std::vector<double>(distances.size()));
+
+	std::cout << "[\'Distance (bytes)\'";
+	for(Kernel const& kernel : kKernels)
+		std::cout << ",\'" << kernel.name << " b-a\',\'" << kernel.name << " d-a\'";
+
+	for(std::size_t i = 0; i < distances.size(); ++i)
+	{
+		std::cout << "],\n" << "[" << distances[i];
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			placement bp(kPageBytes, distances[i]);
+			placement dp(kPageBytes, fixed);
+			if(CanRun(kernel, dp, ap) && is_aligned(bp, kernel.alignment))
+			{
+				trial_stats stats = kernel.run(kernel.name, dp, ap, bp, dest.data(), a_region, b_region);
+				b_bandwidth[k][i] = GigabytesPerSecond(stats);
+			}
+
+			bp.offset = fixed;
+			dp.offset = distances[i];
+			if(CanRun(kernel, dp, ap) && is_aligned(bp, kernel.alignment))
+			{
+				trial_stats stats = kernel.run(kernel.name, dp, ap, bp, dest.data(), a_region, b_region);
+				d_bandwidth[k][i] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << b_bandwidth[k][i] << "," << d_bandwidth[k][i];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		for(std::size_t i : detect_cliffs(b_bandwidth[k], gAliasThreshold))
+		{
+			std::cerr << "aliasing cliff: " << kKernels[k].name
+					  << " b-a " << distances[i] << " bytes "
+					  << b_bandwidth[k][i] << " GB/s" << std::endl;
+		}
+
+		for(std::size_t i : detect_cliffs(d_bandwidth[k], gAliasThreshold))
+		{
+			std::cerr << "aliasing cliff: " << kKernels[k].name
+					  << " d-a " << distances[i] << " bytes "
+					  << d_bandwidth[k][i] << " GB/s" << std::endl;
+		}
+	}
+}
+
+// Runs every kernel at each size from 1 to tail-max-floats, where the
+// tail strategy is most of the work, and plots cycles per call.
+void RunTailSweep()
+{
+	std::size_t const b_offset = SourceRegionFloats(gTailMaxFloats, gSourcePlacement);
+	std::vector<float> source(2 * b_offset, gCheckValue);
+	std::vector<float> dest(gTailMaxFloats + placement_padding(gDestPlacement) / sizeof(float), 0.f);
+
+	PrintColumns("Floats");
+	for(std::size_t n = 1; n <= gTailMaxFloats; ++n)
+	{
+		gNumFloats = n;
+		gTotalFloats = (gTailTotalFloats + n - 1) / n * n;
+		std::cout << "],\n" << "[" << n;
+		for(Kernel const& kernel : kKernels)
+		{
+			trial_stats stats;
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+				stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, gSourcePlacement, dest.data(), source.data(), source.data() + b_offset);
+
+			std::cout << "," << CyclesPerFloat(stats) * n;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Walks the working set (both sources plus destination) from L1 sized
+// to DRAM sized and plots bandwidth. Buffers use the src/dst placements
+// from the command line. As in every sweep the second source starts
+// SourceRegionFloats past the first.
+void RunSizeSweep()
+{
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::size_t const bytes_per_float = kStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	page_buffer source_pages(2 * SourceRegionFloats(max_floats, gSourcePlacement) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_floats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(sizes.size()));
+	std::vector<std::size_t> working_sets(sizes.size());
+
+	PrintColumns("Working Set (KiB)");
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+	{
+		// Whole cache lines per buffer so every vector width divides.
+		gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+		gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+		working_sets[s] = gNumFloats * bytes_per_float;
+		std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+
+		std::cout << "],\n" << "[" << working_sets[s] / 1024.0;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				trial_stats stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, gSourcePlacement, dest, source, source + b_offset);
+				bandwidth[k][s] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << bandwidth[k][s];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		std::cerr << "knees for " << kKernels[k].name << ":";
+		for(knee const& kn : detect_knees(bandwidth[k]))
+		{
+			std::cerr << " " << format_bytes(working_sets[kn.first])
+					  << "-" << format_bytes(working_sets[kn.last])
+					  << " (-" << kn.drop * 100 << "%)";
+		}
+
+		std::cerr << std::endl;
+	}
+}
+
+// Runs every kernel with 1 to threads pinned threads sharing one DRAM
+// sized buffer and plots the aggregate bandwidth, then reports where
+// each kernel stops scaling.
+void RunThreadSweep(std::vector<int> const& cpus)
+{
+	gNumFloats = gThreadNumFloats;
+	gTotalFloats = (std::max(gThreadTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+	page_buffer source_pages(2 * b_offset * sizeof(float), gPageKind);
+	page_buffer dest_pages((gNumFloats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(gMaxThreads));
+
+	PrintColumns("Threads");
+	for(std::size_t t = 1; t <= gMaxThreads; ++t)
+	{
+		thread_team team(t, cpus);
+		std::cout << "],\n" << "[" << t;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				trial_stats stats = kernel.run_parallel(kernel.name, team, gDestPlacement, gSourcePlacement, gSourcePlacement, dest, source, source + b_offset);
+				bandwidth[k][t - 1] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << bandwidth[k][t - 1];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	// Saturation is the first thread count within gSaturationFraction
+	// of the best bandwidth that kernel reached.
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		std::vector<double> const& bw = bandwidth[k];
+		double peak = *std::max_element(bw.begin(), bw.end());
+		if(peak <= 0)
+			continue;
+
+		std::size_t saturated = 0;
+		while(bw[saturated] < gSaturationFraction * peak)
+			++saturated;
+
+		std::cerr << kKernels[k].name << " saturates at " << saturated + 1 << " threads, "
+				  << bw[saturated] << " GB/s of peak " << peak << " GB/s, "
+				  << bw[saturated] / ((saturated + 1) * bw[0]) * 100 << "% scaling efficiency"
+				  << std::endl;
+	}
+}
+
+// Runs every kernel with a and b bound to one NUMA node and the
+// destination bound to another, for every pair of nodes, and draws a
+// source x destination node bandwidth heatmap per kernel. The team runs
+// on the cpus of numa-cpu-node, or of the destination node by default,
+// unless cpus= overrides them.
+void RunNumaMatrix(std::vector<int> const& cpus)
+{
+	gNumFloats = gThreadNumFloats;
+	gTotalFloats = (std::max(gThreadTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+	std::size_t const source_floats = 2 * b_offset;
+	std::size_t const dest_floats = gNumFloats + placement_padding(gDestPlacement) / sizeof(float);
+
+	std::vector<int> nodes = numa_nodes();
+	std::vector<std::unique_ptr<numa_buffer>> sources;
+	std::vector<std::unique_ptr<numa_buffer>> dests;
+	for(int node : nodes)
+	{
+		sources.emplace_back(new numa_buffer(source_floats * sizeof(float), node, gPageKind));
+		dests.emplace_back(new numa_buffer(dest_floats * sizeof(float), node, gPageKind));
+		if(!sources.back()->data<float>() || !dests.back()->data<float>())
+		{
+			std::cerr << "failed to map buffers for node " << node << std::endl;
+			std::exit(1);
+		}
+
+		float* source = sources.back()->data<float>();
+		std::fill(source, source + source_floats, gCheckValue);
+		float* dest = dests.back()->data<float>();
+		std::fill(dest, dest + dest_floats, 0.f);
+
+		std::cerr << "node " << node
+				  << ": source " << (sources.back()->bound() ? "bound" : "unbound") << " on node " << numa_page_node(source)
+				  << ", dest " << (dests.back()->bound() ? "bound" : "unbound") << " on node " << numa_page_node(dest)
+				  << ", cpus";
+		for(int cpu : numa_node_cpus(node))
+			std::cerr << " " << cpu;
+		std::cerr << std::endl;
+	}
+
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> cells(num_kernels, std::vector<double>(nodes.size() * nodes.size()));
+	for(std::size_t d = 0; d < nodes.size(); ++d)
+	{
+		std::vector<int> team_cpus = cpus;
+		if(team_cpus.empty())
+			team_cpus = numa_node_cpus(gNumaCpuNode >= 0 ? gNumaCpuNode : nodes[d]);
+
+		std::size_t threads = gNumaThreads != 0 ? gNumaThreads : std::max<std::size_t>(1, team_cpus.size());
+		thread_team team(threads, team_cpus);
+		for(std::size_t s = 0; s < nodes.size(); ++s)
+		{
+			float* source = sources[s]->data<float>();
+			float* dest = dests[d]->data<float>();
+			for(std::size_t k = 0; k < num_kernels; ++k)
+			{
+				Kernel const& kernel = kKernels[k];
+				if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+				{
+					trial_stats stats = kernel.run_parallel(kernel.name, team, gDestPlacement, gSourcePlacement, gSourcePlacement, dest, source, source + b_offset);
+					cells[k][s * nodes.size() + d] = GigabytesPerSecond(stats);
+				}
+			}
+		}
+	}
+
+	std::vector<std::size_t> labels(nodes.begin(), nodes.end());
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		if(gHtmlOut)
+		{
+			heatmap_table(std::cout, kKernels[k].name, "src node", "dst node", labels, labels, cells[k]);
+		}
+		else
+		{
+			std::cout << kKernels[k].name << "\n";
+			for(std::size_t s = 0; s < nodes.size(); ++s)
+			{
+				std::cout << labels[s];
+				for(std::size_t d = 0; d < nodes.size(); ++d)
+					std::cout << "," << cells[k][s * nodes.size() + d];
+				std::cout << "\n";
+			}
+		}
+	}
+}
+
+// Runs every kernel over DRAM sized buffers backed by each page kind and
+// reports the change in bandwidth against 4k pages. Kinds the host
+// cannot map, such as hugetlb sizes with no reserved pages, stay at 0.
+void RunPageSweep()
+{
+	gNumFloats = gPagesNumFloats;
+	gTotalFloats = (std::max(gPagesTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+	std::size_t const source_floats = 2 * b_offset;
+	std::size_t const dest_floats = gNumFloats + placement_padding(gDestPlacement) / sizeof(float);
+	std::cerr << "transparent_hugepage " << read_sysfs_line("/sys/kernel/mm/transparent_hugepage/enabled") << std::endl;
+
+	page_kind const kinds[] = { page_kind::small, page_kind::thp, page_kind::huge_2m, page_kind::huge_1g };
+	std::size_t const num_kinds = sizeof(kinds) / sizeof(kinds[0]);
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(num_kinds));
+
+	PrintColumns("Pages");
+	for(std::size_t p = 0; p < num_kinds; ++p)
+	{
+		page_buffer source_pages(source_floats * sizeof(float), kinds[p]);
+		page_buffer dest_pages(dest_floats * sizeof(float), kinds[p]);
+		bool const mapped = source_pages.data<float>() && dest_pages.data<float>();
+		if(!mapped)
+			std::cerr << page_kind_name(kinds[p]) << " pages unavailable" << std::endl;
+
+		std::cout << "],\n" << "[\'" << page_kind_name(kinds[p]) << "\'";
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			if(mapped && CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				float* source = FillPages(source_pages, gCheckValue);
+				float* dest = FillPages(dest_pages, 0.f);
+				trial_stats stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, gSourcePlacement, dest, source, source + b_offset);
+				bandwidth[k][p] = GigabytesPerSecond(stats);
+			}
+
+			std::cout << "," << bandwidth[k][p];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		std::vector<double> const& bw = bandwidth[k];
+		if(bw[0] <= 0)
+			continue;
+
+		std::cerr << kKernels[k].name << " vs 4k:";
+		for(std::size_t p = 1; p < num_kinds; ++p)
+		{
+			std::cerr << " " << page_kind_name(kinds[p]) << " ";
+			if(bw[p] > 0)
+				std::cerr << std::showpos << (bw[p] / bw[0] - 1) * 100 << std::noshowpos << "%";
+			else
+				std::cerr << "n/a";
+		}
+
+		std::cerr << std::endl;
+	}
+}
+
+// Runs single passes of every kernel into freshly mapped destinations
+// under each fault policy and plots the bandwidth including setup, which
+// is what a copy into a newly allocated buffer really costs. The fault
+// cost is reported as the cold pass less the warm one.
+void RunFaultSweep(std::vector<int> const& cpus)
+{
+	gNumFloats = gFaultNumFloats;
+	gTotalFloats = gNumFloats;
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+	std::vector<float> source(2 * b_offset, gCheckValue);
+	thread_team team(gFaultThreads, cpus);
+
+	fault_policy const policies[] = { fault_policy::cold, fault_policy::populate, fault_policy::prefault, fault_policy::warm };
+	std::size_t const num_policies = sizeof(policies) / sizeof(policies[0]);
+	std::size_t const num_kernels = sizeof(kKernels) / sizeof(kKernels[0]);
+	std::vector<std::vector<cold_stats>> stats(num_kernels, std::vector<cold_stats>(num_policies));
+
+	PrintColumns("Destination");
+	for(std::size_t p = 0; p < num_policies; ++p)
+	{
+		std::cout << "],\n" << "[\'" << fault_policy_name(policies[p]) << "\'";
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			Kernel const& kernel = kKernels[k];
+			double bandwidth = 0;
+			if(CanRun(kernel, gDestPlacement, gSourcePlacement))
+			{
+				stats[k][p] = kernel.run_cold(kernel.name, policies[p], team, gDestPlacement, gSourcePlacement, gSourcePlacement, source.data(), source.data() + b_offset);
+				trial_stats total = stats[k][p].run;
+				total.median += stats[k][p].setup.median;
+				bandwidth = GigabytesPerSecond(total);
+			}
+
+			std::cout << "," << bandwidth;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	std::size_t const pages = (gNumFloats * sizeof(float) + page_kind_bytes(gPageKind) - 1) / page_kind_bytes(gPageKind);
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		cold_stats const& cold = stats[k][0];
+		cold_stats const& warm = stats[k][num_policies - 1];
+		if(cold.run.count == 0)
+			continue;
+
+		double fault_seconds = cold.run.median - warm.run.median;
+		std::cerr << kKernels[k].name
+				  << ": faults " << fault_seconds * 1e3 << " ms of " << cold.run.median * 1e3 << " ms cold"
+				  << " (" << seconds_to_cycles(fault_seconds) / pages << " cycles/page)";
+		for(std::size_t p = 1; p + 1 < num_policies; ++p)
+		{
+			std::cerr << ", " << fault_policy_name(policies[p])
+					  << " setup " << stats[k][p].setup.median * 1e3 << " ms"
+					  << " + run " << stats[k][p].run.median * 1e3 << " ms";
+		}
+
+		std::cerr << std::endl;
+	}
+}
+
+// Sweeps prefetch distance against working set size for every
+// prefetching variant and draws each as a heatmap of its bandwidth as a
+// percentage of the same loop without prefetches. The best distance per
+// size goes to stderr. A non-zero prefetch-distance runs just that one
+// distance instead of the min to max sweep.
+void RunPrefetchSweep()
+{
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::vector<std::size_t> distances;
+	if(gPrefetchDistance != 0)
+	{
+		distances.push_back(gPrefetchDistance);
+	}
+	else
+	{
+		for(std::size_t distance = gPrefetchMinDistance; distance <= gPrefetchMaxDistance; distance *= 2)
+			distances.push_back(distance);
+	}
+
+	std::size_t const bytes_per_float = kStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	page_buffer source_pages(2 * SourceRegionFloats(max_floats, gSourcePlacement) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_floats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::vector<std::size_t> working_sets(sizes.size());
+	for(PrefetchKernel const& kernel : kPrefetchKernels)
+	{
+		if((kernel.isa & gCpuFeatures) != kernel.isa)
+			continue;
+
+		std::vector<double> cells(sizes.size() * distances.size());
+		for(std::size_t s = 0; s < sizes.size(); ++s)
+		{
+			gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+			gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+			working_sets[s] = gNumFloats * bytes_per_float;
+			std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+			double baseline = GigabytesPerSecond(kernel.baseline(kernel.name, gDestPlacement, gSourcePlacement, gSourcePlacement, dest, source, source + b_offset));
+			std::size_t best = 0;
+			for(std::size_t p = 0; p < distances.size(); ++p)
+			{
+				gPrefetchDistance = distances[p];
+				double bandwidth = GigabytesPerSecond(kernel.run(kernel.name, gDestPlacement, gSourcePlacement, gSourcePlacement, dest, source, source + b_offset));
+				cells[s * distances.size() + p] = baseline > 0 ? bandwidth / baseline * 100 : 0;
+				if(cells[s * distances.size() + p] > cells[s * distances.size() + best])
+					best = p;
+			}
+
+			std::cerr << kernel.name << " at " << format_bytes(working_sets[s])
+					  << ": best distance " << distances[best]
+					  << " (" << cells[s * distances.size() + best] << "% of no prefetch)" << std::endl;
+		}
+
+		if(gHtmlOut)
+		{
+			heatmap_table(std::cout, kernel.name, "working set", "distance", working_sets, distances, cells);
+		}
+		else
+		{
+			std::cout << kernel.name << "\n";
+			for(std::size_t s = 0; s < sizes.size(); ++s)
+			{
+				std::cout << working_sets[s];
+				for(std::size_t p = 0; p < distances.size(); ++p)
+					std::cout << "," << cells[s * distances.size() + p];
+				std::cout << "\n";
+			}
+		}
+	}
+}
+
+// Runs every generated kernel family at each unroll depth over the
+// num-floats buffers and plots bandwidth against unroll. Small buffers
+// show loop overhead and port pressure; DRAM sized ones mostly do not.
+void RunUnrollSweep()
+{
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+	std::vector<float> source(2 * b_offset, gCheckValue);
+	std::vector<float> dest(gNumFloats + placement_padding(gDestPlacement) / sizeof(float), 0.f);
+
+	std::vector<std::string> families;
+	for(UnrolledKernel const& kernel : kUnrolledKernels)
+	{
+		if(std::find(families.begin(), families.end(), kernel.family) == families.end())
+			families.push_back(kernel.family);
+	}
+
+	std::cout << "[\'Unroll\'";
+	for(std::string const& family : families)
+		std::cout << ",\'" << family << "\'";
+
+	for(int unroll = 1; unroll <= 8; unroll *= 2)
+	{
+		std::cout << "],\n" << "[" << unroll;
+		for(std::string const& family : families)
+		{
+			double bandwidth = 0;
+			for(UnrolledKernel const& kernel : kUnrolledKernels)
+			{
+				if(kernel.family != family || kernel.unroll != unroll)
+					continue;
+
+				bool const runnable = (kernel.isa & gCpuFeatures) == kernel.isa
+								   && is_aligned(gDestPlacement, kernel.alignment)
+								   && is_aligned(gSourcePlacement, kernel.alignment);
+				if(runnable)
+				{
+					std::string name = family + " x" + std::to_string(unroll);
+					bandwidth = GigabytesPerSecond(kernel.run(name.c_str(), gDestPlacement, gSourcePlacement, gSourcePlacement, dest.data(), source.data(), source.data() + b_offset));
+				}
+			}
+
+			std::cout << "," << bandwidth;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Runs every fma kernel across the working set sweep. In cache the
+// kernels are bound by the multiply and add ports, so fusing pays; out
+// of cache three input streams are the limit and the variants converge.
+// Reports each kernel's peak and where it fell to.
+void RunFmaSweep()
+{
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::size_t const bytes_per_float = kFmaStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	page_buffer source_pages(3 * SourceRegionFloats(max_floats, gSourcePlacement) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_floats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* source = FillPages(source_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::size_t const num_kernels = sizeof(kFmaKernels) / sizeof(kFmaKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels, std::vector<double>(sizes.size()));
+	std::vector<std::vector<double>> flops(num_kernels, std::vector<double>(sizes.size()));
+	std::vector<std::size_t> working_sets(sizes.size());
+
+	std::cout << "[\'Working Set (KiB)\'";
+	for(FmaKernel const& kernel : kFmaKernels)
+		std::cout << ",\'" << kernel.name << "\'";
+
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+	{
+		gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+		gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+		working_sets[s] = gNumFloats * bytes_per_float;
+		std::size_t const stride = SourceRegionFloats(gNumFloats, gSourcePlacement);
+
+		std::cout << "],\n" << "[" << working_sets[s] / 1024.0;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			FmaKernel const& kernel = kFmaKernels[k];
+			bool const runnable = (kernel.isa & gCpuFeatures) == kernel.isa
+							   && is_aligned(gDestPlacement, kernel.alignment)
+							   && is_aligned(gSourcePlacement, kernel.alignment);
+			if(runnable)
+			{
+				trial_stats stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest, source, source + stride, source + 2 * stride);
+				bandwidth[k][s] = GigabytesPerSecond(stats, kFmaStreamsPerFloat);
+				flops[k][s] = stats.median > 0 ? 2 / CyclesPerFloat(stats) : 0;
+			}
+
+			std::cout << "," << bandwidth[k][s];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		if(sizes.empty() || flops[k].back() <= 0)
+			continue;
+
+		std::size_t peak = std::max_element(flops[k].begin(), flops[k].end()) - flops[k].begin();
+		std::cerr << kFmaKernels[k].name << ": peak " << flops[k][peak] << " flops/cycle at " << format_bytes(working_sets[peak])
+				  << ", " << flops[k].back() << " flops/cycle (" << bandwidth[k].back() << " GB/s) at " << format_bytes(working_sets.back())
+				  << std::endl;
+	}
+}
+
+// Runs every reduction family at 1, 2, 4 and 8 accumulators over the
+// num-floats buffer and plots floats per cycle. With one accumulator
+// each add waits for the last, so a reduction runs at the add latency
+// rather than at load bandwidth until there are enough accumulators to
+// cover it.
+//
+// a flips sign every 128 floats, more than any kernel's accumulators
+// span, so every partial sum stays small and a DRAM sized float sum
+// does not stall at 2^24. b stays positive so the dot product
+// alternates too.
+void RunReduceSweep()
+{
+	std::size_t const b_offset = SourceRegionFloats(gNumFloats, gSourcePlacement);
+	std::vector<float> source(2 * b_offset);
+	for(std::size_t j = 0; j < b_offset; ++j)
+	{
+		float const magnitude = gCheckValue + float(j & 0x7f) / 128;
+		source[j] = (j & 0x80) ? -magnitude : magnitude;
+		source[b_offset + j] = gCheckValue + float(j & 0xff) / 256;
+	}
+
+	std::vector<std::string> families;
+	for(ReduceKernel const& kernel : kReduceKernels)
+	{
+		if(std::find(families.begin(), families.end(), kernel.family) == families.end())
+			families.push_back(kernel.family);
+	}
+
+	std::cout << "[\'Accumulators\'";
+	for(std::string const& family : families)
+		std::cout << ",\'" << family << "\'";
+
+	for(int accumulators = 1; accumulators <= 8; accumulators *= 2)
+	{
+		std::cout << "],\n" << "[" << accumulators;
+		for(std::string const& family : families)
+		{
+			double floats_per_cycle = 0;
+			for(ReduceKernel const& kernel : kReduceKernels)
+			{
+				if(kernel.family != family || kernel.accumulators != accumulators)
+					continue;
+
+				if((kernel.isa & gCpuFeatures) == kernel.isa)
+				{
+					std::string name = family + " x" + std::to_string(accumulators);
+					trial_stats stats = kernel.run(name.c_str(), gSourcePlacement, source.data(), source.data() + b_offset);
+					floats_per_cycle = stats.median > 0 ? 1 / CyclesPerFloat(stats) : 0;
+				}
+			}
+
+			std::cout << "," << floats_per_cycle;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// The STREAM benchmark on threads pinned threads: Copy, Scale, Add and
+// Triad over three separately mapped arrays of stream-num-floats,
+// which should each be several times the last level cache. Bandwidth is
+// counted as STREAM counts it, so the best rates are comparable with
+// published STREAM results, though the elements here are floats rather
+// than STREAM's doubles.
+void RunStreamSuite(std::vector<int> const& cpus)
+{
+	gNumFloats = gStreamNumFloats;
+	gTotalFloats = gNumFloats;
+	std::size_t const a_floats = gNumFloats + placement_padding(gSourcePlacement) / sizeof(float);
+	page_buffer a_pages(a_floats * sizeof(float), gPageKind);
+	page_buffer b_pages(a_floats * sizeof(float), gPageKind);
+	page_buffer dest_pages((gNumFloats + kGuardFloats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* a = FillPages(a_pages, gCheckValue);
+	float* b = FillPages(b_pages, gCheckValue);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	thread_team team(gMaxThreads, cpus);
+	std::cerr << "stream: " << gMaxThreads << " threads, " << format_bytes(gNumFloats * sizeof(float)) << " per array" << std::endl;
+	std::cerr << "Function                  Best Rate MB/s     Avg time     Min time     Max time" << std::endl;
+
+	std::vector<std::string> families;
+	for(StreamKernel const& kernel : kStreamKernels)
+	{
+		if(std::find(families.begin(), families.end(), kernel.family) == families.end())
+			families.push_back(kernel.family);
+	}
+
+	std::cout << "[\'Kernel\'";
+	for(std::string const& family : families)
+		std::cout << ",\'" << family << "\'";
+
+	for(int op = kStreamCopy; op <= kStreamTriad; ++op)
+	{
+		std::cout << "],\n" << "[\'" << StreamOpName(op) << "\'";
+		for(std::string const& family : families)
+		{
+			double bandwidth = 0;
+			for(StreamKernel const& kernel : kStreamKernels)
+			{
+				if(kernel.family != family || kernel.op != op)
+					continue;
+
+				bool const runnable = (kernel.isa & gCpuFeatures) == kernel.isa
+								   && is_aligned(gDestPlacement, kernel.alignment)
+								   && is_aligned(gSourcePlacement, kernel.alignment);
+				if(runnable)
+				{
+					std::string name = family + " " + StreamOpName(op) + ":";
+					trial_stats stats = kernel.run(name.c_str(), team, gDestPlacement, gSourcePlacement, dest, a, b);
+					if(stats.min > 0)
+						bandwidth = double(StreamWordsPerFloat(op)) * sizeof(float) * gNumFloats / stats.min / 1e9;
+				}
+			}
+
+			std::cout << "," << bandwidth;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Runs the for-loop and vector multiply for every element type over
+// buffers of num-floats floats' worth of bytes, and plots bandwidth per
+// type. Elements per cycle are in the log.
+void RunTypeSweep()
+{
+	std::size_t const bytes = (gNumFloats + kGuardFloats) * sizeof(float);
+	page_buffer a_pages(bytes + placement_padding(gSourcePlacement), gPageKind);
+	page_buffer b_pages(bytes + placement_padding(gSourcePlacement), gPageKind);
+	page_buffer dest_pages(bytes + placement_padding(gDestPlacement), gPageKind);
+	FillPages(a_pages, 0.f);
+	FillPages(b_pages, 0.f);
+	FillPages(dest_pages, 0.f);
+
+	char const* const kinds[] = { "for-loop", "Vector" };
+	std::vector<std::string> types;
+	for(TypedKernel const& kernel : kTypedKernels)
+	{
+		if(std::find(types.begin(), types.end(), kernel.type) == types.end())
+			types.push_back(kernel.type);
+	}
+
+	std::cout << "[\'Element Type\'";
+	for(char const* kind : kinds)
+		std::cout << ",\'" << kind << "\'";
+
+	for(std::string const& type : types)
+	{
+		std::cout << "],\n" << "[\'" << type << "\'";
+		for(char const* kind : kinds)
+		{
+			double bandwidth = 0;
+			for(TypedKernel const& kernel : kTypedKernels)
+			{
+				bool const is_loop = std::string(kernel.name) == "for-loop";
+				if(kernel.type != type || is_loop != (kind == kinds[0]))
+					continue;
+
+				if((kernel.isa & gCpuFeatures) == kernel.isa)
+				{
+					std::string name = std::string(kernel.name) + " " + type;
+					trial_stats stats = kernel.run(name.c_str(), gDestPlacement, gSourcePlacement, dest_pages.data<void>(), a_pages.data<void>(), b_pages.data<void>());
+					bandwidth = GigabytesPerSecond(stats);
+				}
+			}
+
+			std::cout << "," << bandwidth;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+}
+
+// Runs the convert kernels across the working set sweep, sized as the
+// float baseline's working set, and plots elements per second. Then
+// reports each kernel against the baseline at the smallest and largest
+// sizes: in cache the conversions cost, out of cache the halved input
+// traffic may pay for them.
+void RunConvertSweep()
+{
+	std::vector<std::size_t> sizes = sweep_sizes(gSweepMinBytes, gSweepMaxBytes, gSweepStepsPerOctave);
+	std::size_t const bytes_per_float = kStreamsPerFloat * sizeof(float);
+	std::size_t const max_floats = sizes.empty() ? 0 : sizes.back() / bytes_per_float;
+	std::size_t const bytes = (max_floats + kGuardFloats) * sizeof(float);
+	page_buffer a_pages(bytes + placement_padding(gSourcePlacement), gPageKind);
+	page_buffer b_pages(bytes + placement_padding(gSourcePlacement), gPageKind);
+	page_buffer dest_pages(bytes + placement_padding(gDestPlacement), gPageKind);
+	FillPages(a_pages, 0.f);
+	FillPages(b_pages, 0.f);
+	FillPages(dest_pages, 0.f);
+
+	std::size_t const num_kernels = sizeof(kConvertKernels) / sizeof(kConvertKernels[0]);
+	std::vector<std::vector<double>> rate(num_kernels, std::vector<double>(sizes.size()));
+	std::vector<std::size_t> working_sets(sizes.size());
+
+	std::cout << "[\'Float Working Set (KiB)\'";
+	for(ConvertKernel const& kernel : kConvertKernels)
+		std::cout << ",\'" << kernel.name << "\'";
+
+	for(std::size_t s = 0; s < sizes.size(); ++s)
+	{
+		gNumFloats = std::max<std::size_t>(16, (sizes[s] / bytes_per_float) & ~std::size_t(15));
+		gTotalFloats = (std::max(gSweepTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+		working_sets[s] = gNumFloats * bytes_per_float;
+
+		std::cout << "],\n" << "[" << working_sets[s] / 1024.0;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			ConvertKernel const& kernel = kConvertKernels[k];
+			bool const runnable = (kernel.isa & gCpuFeatures) == kernel.isa
+							   && is_aligned(gDestPlacement, kernel.alignment)
+							   && is_aligned(gSourcePlacement, kernel.alignment);
+			if(runnable)
+			{
+				trial_stats stats = kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest_pages.data<void>(), a_pages.data<void>(), b_pages.data<void>());
+				rate[k][s] = stats.median > 0 ? gTotalFloats / stats.median / 1e9 : 0;
+			}
+
+			std::cout << "," << rate[k][s];
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	if(sizes.empty() || rate[0].front() <= 0)
+		return;
+
+	for(std::size_t k = 1; k < num_kernels; ++k)
+	{
+		if(rate[k].front() <= 0)
+			continue;
+
+		std::cerr << kConvertKernels[k].name << " vs. " << kConvertKernels[0].name << ": "
+				  << rate[k].front() / rate[0].front() << "x at " << format_bytes(working_sets.front()) << ", "
+				  << rate[k].back() / rate[0].back() << "x at " << format_bytes(working_sets.back())
+				  << std::endl;
+	}
+}
+
+// Runs the strided and indexed kernels over num-floats floats at every
+// power of two stride from stride-min to stride-max and plots the
+// bandwidth of the floats actually used. Source values vary so a wrong
+// offset fails validation. Reports what each kernel keeps of its
+// smallest stride bandwidth at the largest.
+void RunStrideSweep()
+{
+	gTotalFloats = (std::max(gStrideTotalFloats, gNumFloats) + gNumFloats - 1) / gNumFloats * gNumFloats;
+	std::size_t const max_span = gNumFloats * gStrideMax;
+	page_buffer a_pages((max_span + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer b_pages((max_span + placement_padding(gSourcePlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	page_buffer dest_pages((max_span + kGuardFloats + placement_padding(gDestPlacement) / sizeof(float)) * sizeof(float), gPageKind);
+	float* a = place(FillPages(a_pages, 0.f), gSourcePlacement);
+	float* b = place(FillPages(b_pages, 0.f), gSourcePlacement);
+	float* dest = FillPages(dest_pages, 0.f);
+
+	std::vector<std::int32_t> index(gNumFloats);
+	std::mt19937 random(1);
+	std::size_t const num_kernels = sizeof(kIndexedKernels) / sizeof(kIndexedKernels[0]);
+	std::vector<std::vector<double>> bandwidth(num_kernels);
+
+	std::cout << "[\'Stride (floats)\'";
+	for(IndexedKernel const& kernel : kIndexedKernels)
+		std::cout << ",\'" << kernel.name << "\'";
+
+	for(std::size_t stride = gStrideMin; stride <= gStrideMax; stride *= 2)
+	{
+		gStride = stride;
+		for(std::size_t i = 0; i < gNumFloats; ++i)
+			index[i] = std::int32_t(i * stride);
+
+		std::shuffle(index.begin(), index.end(), random);
+		for(std::size_t j = 0; j < gNumFloats * stride; ++j)
+		{
+			a[j] = gCheckValue + float(j & 0xfff);
+			b[j] = gCheckValue + float(j & 0xff);
+		}
+
+		std::cout << "],\n" << "[" << stride;
+		for(std::size_t k = 0; k < num_kernels; ++k)
+		{
+			IndexedKernel const& kernel = kIndexedKernels[k];
+			double gbps = 0;
+			if((kernel.isa & gCpuFeatures) == kernel.isa)
+				gbps = GigabytesPerSecond(kernel.run(kernel.name, gDestPlacement, gSourcePlacement, dest, a_pages.data<float>(), b_pages.data<float>(), index.data()));
+
+			bandwidth[k].push_back(gbps);
+			std::cout << "," << gbps;
+		}
+	}
+
+	std::cout << "]" << std::endl;
+
+	for(std::size_t k = 0; k < num_kernels; ++k)
+	{
+		if(bandwidth[k].empty() || bandwidth[k].front() <= 0)
+			continue;
+
+		std::cerr << kIndexedKernels[k].name << ": " << bandwidth[k].front() << " GB/s at stride " << gStrideMin
+				  << ", " << bandwidth[k].back() / bandwidth[k].front() * 100 << "% of that at stride " << gStride
+				  << std::endl;
+	}
+}
+
+// ----------------------------------------------------------------------------
+//
+void print_usage()
+{
+	std::cerr << "Usage:\n" 
+			  << "simd-mult [options]\n"
+			  << "num-floats=<number of float in memory>    default (" << kDefaultNumFloats << ")\n"
+			  << "total-floats=<number of floats total>     default (" << kDefaultTotalFloats << ")\n"
+			  << "check-value=<any value to check against>  default (" << gCheckValue << ")\n"
+			  << "trials=<measured runs per cell>           default (" << gTrials << ")\n"
+			  << "warmup=<discarded runs per cell>          default (" << gWarmupTrials << ")\n"
+			  << "bootstrap-resamples=<number>              default (" << gBootstrapResamples << ")\n"
+			  << "confidence=<ci level in (0, 1)>           default (" << gConfidence << ")\n"
+			  << "timer=<wall/tsc>                          default (" << timing_backend_name(gTimingBackend) << ")\n"
+			  << "report-cycles=<true/false>                default (" << std::boolalpha << gReportCycles << ")\n"
+			  << "counters=<true/false>                     default (" << std::boolalpha << gCollectCounters << ")\n"
+			  << "mode=<alignment/size/heatmap/aliasing/tail/threads/numa/pages/fault/prefetch/unroll/fma/reduce/stream/types/convert/stride> default (" << gMode << ")\n"
+			  << "sweep-min-bytes=<smallest working set>    default (" << gSweepMinBytes << ")\n"
+			  << "sweep-max-bytes=<largest working set>     default (" << gSweepMaxBytes << ")\n"
+			  << "sweep-steps=<sizes per doubling>          default (" << gSweepStepsPerOctave << ")\n"
+			  << "sweep-total-floats=<floats per trial>     default (" << gSweepTotalFloats << ")\n"
+			  << "src-base=<power of two alignment>         default (" << gSourcePlacement.base << ")\n"
+			  << "src-offset=<bytes past src-base>          default (" << gSourcePlacement.offset << ")\n"
+			  << "dst-base=<power of two alignment>         default (" << gDestPlacement.base << ")\n"
+			  << "dst-offset=<bytes past dst-base>          default (" << gDestPlacement.offset << ")\n"
+			  << "alias-step=<bytes between distances>      default (" << gAliasStep << ")\n"
+			  << "alias-window=<fine bytes at page edges>   default (" << gAliasWindow << ")\n"
+			  << "alias-threshold=<cliff fraction>          default (" << gAliasThreshold << ")\n"
+			  << "tail-max-floats=<largest tail mode size>  default (" << gTailMaxFloats << ")\n"
+			  << "tail-total-floats=<floats per trial>      default (" << gTailTotalFloats << ")\n"
+			  << "threads=<most threads in threads mode>    default (" << gMaxThreads << ")\n"
+			  << "cpus=<cpu list to pin threads to>         default (allowed cpus in order)\n"
+			  << "threads-num-floats=<floats per buffer>    default (" << gThreadNumFloats << ")\n"
+			  << "threads-total-floats=<floats per trial>   default (" << gThreadTotalFloats << ")\n"
+			  << "saturation=<fraction of peak bandwidth>   default (" << gSaturationFraction << ")\n"
+			  << "numa-threads=<threads, 0 for whole node>  default (" << gNumaThreads << ")\n"
+			  << "numa-cpu-node=<node, -1 for dst node>     default (" << gNumaCpuNode << ")\n"
+			  << "pages=<default/4k/thp/2m/1g>              default (" << page_kind_name(gPageKind) << ")\n"
+			  << "pages-num-floats=<floats per buffer>      default (" << gPagesNumFloats << ")\n"
+			  << "pages-total-floats=<floats per trial>     default (" << gPagesTotalFloats << ")\n"
+			  << "fault-num-floats=<floats per buffer>      default (" << gFaultNumFloats << ")\n"
+			  << "fault-threads=<prefaulting threads>       default (" << gFaultThreads << ")\n"
+			  << "prefetch-distance=<bytes ahead, 0 sweeps> default (" << gPrefetchDistance << ")\n"
+			  << "prefetch-min-distance=<bytes ahead>       default (" << gPrefetchMinDistance << ")\n"
+			  << "prefetch-max-distance=<bytes ahead>       default (" << gPrefetchMaxDistance << ")\n"
+			  << "stream-num-floats=<floats per array>      default (" << gStreamNumFloats << ")\n"
+			  << "stride-min=<smallest stride in floats>    default (" << gStrideMin << ")\n"
+			  << "stride-max=<largest stride in floats>     default (" << gStrideMax << ")\n"
+			  << "stride-total-floats=<floats per trial>    default (" << gStrideTotalFloats << ")\n"
+			  << "disable-isa=<comma separated features>    default ()\n"
+			  << "report-html=<true/false>                  default (" << std::boolalpha << gHtmlOut << ")\n"
+			  << std::endl;
+
+}
+
+// ----------------------------------------------------------------------------
+//
+int main(int argc, char** argv)
+{
+	cgutil::program_options opts;
+	opts.add("num-floats", gNumFloats);
+	opts.add("num-floats", gNumFloats);
+	opts.add("total-floats", gTotalFloats);
+	opts.add("check-value", gCheckValue);
+	opts.add("trials", gTrials);
+	opts.add("warmup", gWarmupTrials);
+	opts.add("bootstrap-resamples", gBootstrapResamples);
+	opts.add("confidence", gConfidence);
+	std::string timer = timing_backend_name(gTimingBackend);
+	opts.add("timer", timer);
+	opts.add("report-cycles", gReportCycles);
+	opts.add("counters", gCollectCounters);
+	opts.add("mode", gMode);
+	opts.add("sweep-min-bytes", gSweepMinBytes);
+	opts.add("sweep-max-bytes", gSweepMaxBytes);
+	opts.add("sweep-steps", gSweepStepsPerOctave);
+	opts.add("sweep-total-floats", gSweepTotalFloats);
+	opts.add("src-base", gSourcePlacement.base);
+	opts.add("src-offset", gSourcePlacement.offset);
+	opts.add("dst-base", gDestPlacement.base);
+	opts.add("dst-offset", gDestPlacement.offset);
+	opts.add("alias-step", gAliasStep);
+	opts.add("alias-window", gAliasWindow);
+	opts.add("alias-threshold", gAliasThreshold);
+	opts.add("tail-max-floats", gTailMaxFloats);
+	opts.add("tail-total-floats", gTailTotalFloats);
+	opts.add("threads", gMaxThreads);
+	std::string cpu_list;
+	opts.add("cpus", cpu_list);
+	opts.add("threads-num-floats", gThreadNumFloats);
+	opts.add("threads-total-floats", gThreadTotalFloats);
+	opts.add("saturation", gSaturationFraction);
+	opts.add("numa-threads", gNumaThreads);
+	opts.add("numa-cpu-node", gNumaCpuNode);
+	std::string pages = page_kind_name(gPageKind);
+	opts.add("pages", pages);
+	opts.add("pages-num-floats", gPagesNumFloats);
+	opts.add("pages-total-floats", gPagesTotalFloats);
+	opts.add("fault-num-floats", gFaultNumFloats);
+	opts.add("fault-threads", gFaultThreads);
+	opts.add("prefetch-distance", gPrefetchDistance);
+	opts.add("prefetch-min-distance", gPrefetchMinDistance);
+	opts.add("prefetch-max-distance", gPrefetchMaxDistance);
+	opts.add("stream-num-floats", gStreamNumFloats);
+	opts.add("stride-min", gStrideMin);
+	opts.add("stride-max", gStrideMax);
+	opts.add("stride-total-floats", gStrideTotalFloats);
+	std::string disabled_isa;
+	opts.add("disable-isa", disabled_isa);
+	
+	try
+	{
+		opts.parse(argc, argv);
+	}
+	catch(std::runtime_error e)
+	{
+		std::cerr << e.what() << std::endl;
+		print_usage();
+		std::exit(1);
+	}
+
+	if(gTotalFloats < gNumFloats)
+	{
+		std::cerr << "total-floats must be greater than num-floats" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(!parse_timing_backend(timer, gTimingBackend))
+	{
+		std::cerr << "unknown timer " << timer << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(!parse_page_kind(pages, gPageKind))
+	{
+		std::cerr << "unknown page kind " << pages << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	unsigned disabled = 0;
+	if(!parse_cpu_features(disabled_isa, disabled))
+	{
+		std::cerr << "unknown feature in " << disabled_isa << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	gCpuFeatures = cpu_features() & ~with_dependent_features(disabled);
+	std::cerr << "cpu ";
+	print_cpu_features(std::cerr, gCpuFeatures);
+	std::cerr << std::endl;
+
+	std::cerr << "tsc " << tsc_frequency() / 1e9 << " GHz, "
+			  << "timer overhead " << tsc_overhead() << " cycles (tsc) "
+			  << wall_overhead() << " seconds (wall)"
+			  << std::endl
+	;
+
+	if(gCollectCounters)
+	{
+		gCounters.open();
+		if(!gCounters.available())
+			std::cerr << "perf_event_open unavailable, counters disabled" << std::endl;
+	}
+
+	if(gTrials == 0 || gConfidence <= 0 || gConfidence >= 1)
+	{
+		std::cerr << "trials must be non-zero and confidence in (0, 1)" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(!is_valid_placement<float>(gSourcePlacement) || !is_valid_placement<float>(gDestPlacement))
+	{
+		std::cerr << "bases must be powers of two and offsets multiples of " << sizeof(float) << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gAliasStep == 0 || gAliasWindow >= kPageBytes / 2)
+	{
+		std::cerr << "alias-step must be non-zero and alias-window less than " << kPageBytes / 2 << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMode != "alignment" && gMode != "size" && gMode != "heatmap" && gMode != "aliasing" && gMode != "tail" && gMode != "threads" && gMode != "numa" && gMode != "pages" && gMode != "fault" && gMode != "prefetch" && gMode != "unroll" && gMode != "fma" && gMode != "reduce" && gMode != "stream" && gMode != "types" && gMode != "convert" && gMode != "stride")
+	{
+		std::cerr << "unknown mode " << gMode << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	std::vector<int> cpus;
+	if(!parse_cpu_list(cpu_list, cpus))
+	{
+		std::cerr << "bad cpu list " << cpu_list << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMaxThreads == 0 || gThreadNumFloats == 0 || gStreamNumFloats == 0 || gFaultThreads == 0 || gSaturationFraction <= 0 || gSaturationFraction > 1)
+	{
+		std::cerr << "threads, threads-num-floats, stream-num-floats and fault-threads must be non-zero and saturation in (0, 1]" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMode == "stride" && (gStrideMin == 0 || gStrideMax < gStrideMin || gNumFloats * gStrideMax > std::size_t(std::numeric_limits<std::int32_t>::max())))
+	{
+		std::cerr << "stride-min must be non-zero and no more than stride-max, and num-floats * stride-max must fit an int32 index" << std::endl;
+		print_usage();
+		return 0;
+	}
+
+	if(gMode == "heatmap")
+	{
+		if(gHtmlOut)
+			heatmap_begin(std::cout, "Source vs. Destination Offset (GB/s)");
+
+		RunHeatmap();
+
+		if(gHtmlOut)
+			heatmap_end(std::cout);
+
+		return 0;
+	}
+
+	if(gMode == "prefetch")
+	{
+		if(gPrefetchMinDistance == 0 || gPrefetchMaxDistance < gPrefetchMinDistance)
+		{
+			std::cerr << "prefetch-min-distance must be non-zero and no more than prefetch-max-distance" << std::endl;
+			print_usage();
+			return 0;
+		}
+
+		if(gHtmlOut)
+			heatmap_begin(std::cout, "Prefetch Distance vs. Working Set (% of no prefetch bandwidth)");
+
+		RunPrefetchSweep();
+
+		if(gHtmlOut)
+			heatmap_end(std::cout);
+
+		return 0;
+	}
+
+	if(gMode == "numa")
+	{
+		if(gHtmlOut)
+			heatmap_begin(std::cout, "Source vs. Destination NUMA Node (GB/s)");
+
+		RunNumaMatrix(cpus);
+
+		if(gHtmlOut)
+			heatmap_end(std::cout);
+
+		return 0;
+	}
+
+	if(gHtmlOut)
+		html_begin(std::cout);
+
+	std::string options;
+	char const* chart = "LineChart";
+	if(gMode == "stride")
+	{
+		RunStrideSweep();
+		options = "title: 'Stride vs. Bandwidth of Used Floats',\n"
+				  "          hAxis: {title: 'Stride (floats)', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "convert")
+	{
+		RunConvertSweep();
+		options = "title: 'Working Set vs. Converting Multiply Throughput',\n"
+				  "          hAxis: {title: 'Float Working Set (KiB)', logScale: true},\n"
+				  "          vAxis: {title: 'Gelements/s'}";
+	}
+	else if(gMode == "types")
+	{
+		RunTypeSweep();
+		chart = "ColumnChart";
+		options = "title: 'Element Type vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Element Type'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "stream")
+	{
+		RunStreamSuite(cpus);
+		chart = "ColumnChart";
+		options = "title: 'STREAM Best Rate',\n"
+				  "          hAxis: {title: 'Kernel'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "reduce")
+	{
+		RunReduceSweep();
+		options = "title: 'Accumulators vs. Reduction Throughput',\n"
+				  "          hAxis: {title: 'Independent Accumulators', logScale: true},\n"
+				  "          vAxis: {title: 'Floats per Cycle'}";
+	}
+	else if(gMode == "fma")
+	{
+		RunFmaSweep();
+		options = "title: 'Working Set vs. a * b + c Bandwidth',\n"
+				  "          hAxis: {title: 'Working Set (KiB)', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "unroll")
+	{
+		RunUnrollSweep();
+		options = "title: 'Unroll Depth vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Vectors per Iteration', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "fault")
+	{
+		RunFaultSweep(cpus);
+		chart = "ColumnChart";
+		options = "title: 'Destination Fault Policy vs. Bandwidth Including Setup',\n"
+				  "          hAxis: {title: 'Destination'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "pages")
+	{
+		RunPageSweep();
+		chart = "ColumnChart";
+		options = "title: 'Page Size vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Pages'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "threads")
+	{
+		RunThreadSweep(cpus);
+		options = "title: 'Threads vs. Aggregate Bandwidth',\n"
+				  "          hAxis: {title: 'Threads'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "tail")
+	{
+		RunTailSweep();
+		options = "title: 'Size vs. Cycles per Call',\n"
+				  "          hAxis: {title: 'Floats'},\n"
+				  "          vAxis: {title: 'Cycles'}";
+	}
+	else if(gMode == "aliasing")
+	{
+		RunAliasingSweep();
+		options = "title: 'Buffer Distance mod 4 KiB vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Distance (bytes)'},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else if(gMode == "size")
+	{
+		RunSizeSweep();
+		options = "title: 'Working Set vs. Bandwidth',\n"
+				  "          hAxis: {title: 'Working Set (KiB)', logScale: true},\n"
+				  "          vAxis: {title: 'GB/s'}";
+	}
+	else
+	{
+		RunAlignmentSweep();
+		options = std::string("title: 'Offset vs. ") + (gReportCycles ? "Cycles per Float" : "Run Time") + "'";
+	}
+
+	if(gHtmlOut)
+		html_end(std::cout, chart, options);
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+// sweep.h
+//
+// Sweep helpers: geometric size generation, detection of the bandwidth
+// knees where the working set falls out of a cache level, and of the
+// isolated cliffs buffer layout sweeps look for.
+
+#ifndef SIMDPERF_SWEEP_H_
+#define SIMDPERF_SWEEP_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Sizes from min_bytes to max_bytes inclusive, steps_per_octave points
+// per doubling, each rounded down to a whole cache line.
+inline std::vector<std::size_t> sweep_sizes(std::size_t min_bytes, std::size_t max_bytes, std::size_t steps_per_octave)
+{
+	std::vector<std::size_t> sizes;
+	if(steps_per_octave == 0)
+		steps_per_octave = 1;
+
+	for(std::size_t step = 0;; ++step)
+	{
+		double exact = min_bytes * std::pow(2.0, double(step) / steps_per_octave);
+		if(exact > max_bytes)
+			break;
+
+		std::size_t size = static_cast<std::size_t>(exact) & ~std::size_t(63);
+		if(size == 0)
+			continue;
+
+		if(sizes.empty() || sizes.back() != size)
+			sizes.push_back(size);
+	}
+
+	return sizes;
+}
+
+struct knee
+{
+	std::size_t first; // last index before the drop
+	std::size_t last;  // first index after the drop
+	double drop;       // fraction of bandwidth lost, 0..1
+};
+
+// A knee is a run of consecutive steps on which bandwidth falls by more
+// than noise, whose total fall exceeds min_drop. Zero entries are
+// treated as missing data and end any run.
+inline std::vector<knee> detect_knees(std::vector<double> const& bandwidth, double noise = 0.03, double min_drop = 0.10)
+{
+	std::vector<knee> knees;
+	std::size_t start = 0;
+	bool falling = false;
+	for(std::size_t i = 0; i + 1 < bandwidth.size(); ++i)
+	{
+		bool step_falls = bandwidth[i] > 0 && bandwidth[i + 1] > 0 && bandwidth[i + 1] < bandwidth[i] * (1 - noise);
+		if(step_falls && !falling)
+		{
+			start = i;
+			falling = true;
+		}
+
+		bool run_ends = falling && (!step_falls || i + 2 == bandwidth.size());
+		if(run_ends)
+		{
+			std::size_t end = step_falls ? i + 1 : i;
+			double drop = 1 - bandwidth[end] / bandwidth[start];
+			if(drop >= min_drop)
+			{
+				knee k = { start, end, drop };
+				knees.push_back(k);
+			}
+
+			falling = false;
+		}
+	}
+
+	return knees;
+}
+
+// Indices whose value is more than threshold below the median of the
+// measured (non-zero) values.
+inline std::vector<std::size_t> detect_cliffs(std::vector<double> const& values, double threshold)
+{
+	std::vector<double> measured;
+	for(double v : values)
+	{
+		if(v > 0)
+			measured.push_back(v);
+	}
+
+	std::vector<std::size_t> cliffs;
+	if(measured.empty())
+		return cliffs;
+
+	std::nth_element(measured.begin(), measured.begin() + measured.size() / 2, measured.end());
+	double median = measured[measured.size() / 2];
+	for(std::size_t i = 0; i < values.size(); ++i)
+	{
+		if(values[i] > 0 && values[i] < median * (1 - threshold))
+			cliffs.push_back(i);
+	}
+
+	return cliffs;
+}
+
+// Distances modulo a page to probe for 4K aliasing: every step bytes,
+// plus every float inside window bytes either side of the page
+// boundary, where partial address matches and page-crossing accesses
+// concentrate.
+inline std::vector<std::size_t> aliasing_distances(std::size_t page, std::size_t step, std::size_t window, std::size_t granule)
+{
+	std::vector<std::size_t> distances;
+	for(std::size_t d = 0; d < page; d += granule)
+	{
+		if(d % step == 0 || d < window || d >= page - window)
+			distances.push_back(d);
+	}
+
+	return distances;
+}
+
+inline std::string format_bytes(std::size_t bytes)
+{
+	static char const* const units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+	double value = static_cast<double>(bytes);
+	std::size_t unit = 0;
+	while(value >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0]))
+	{
+		value /= 1024;
+		++unit;
+	}
+
+	std::ostringstream out;
+	out << value << " " << units[unit];
+	return out.str();
+}
+
+#endif // SIMDPERF_SWEEP_H_
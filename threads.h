@@ -0,0 +1,211 @@
+// threads.h
+//
+// A small team of pinned threads for the parallel modes. Members start
+// each job together off a spinning barrier and the caller, which is
+// member 0, returns only when every member has finished, so timing a
+// call to run() measures the slowest thread.
+
+#ifndef SIMDPERF_THREADS_H_
+#define SIMDPERF_THREADS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <immintrin.h>
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+// ----------------------------------------------------------------------------
+//
+class spin_barrier
+{
+public:
+	explicit spin_barrier(std::size_t count)
+		: count_(count)
+		, waiting_(0)
+		, generation_(0)
+	{}
+
+	void wait()
+	{
+		std::size_t generation = generation_.load(std::memory_order_acquire);
+		if(waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_)
+		{
+			waiting_.store(0, std::memory_order_relaxed);
+			generation_.fetch_add(1, std::memory_order_release);
+			return;
+		}
+
+		// Back off to the scheduler now and then in case the team is
+		// larger than the number of free cpus.
+		for(unsigned spins = 1; generation_.load(std::memory_order_acquire) == generation; ++spins)
+		{
+			_mm_pause();
+			if(spins % 4096 == 0)
+				std::this_thread::yield();
+		}
+	}
+
+private:
+	std::size_t const count_;
+	std::atomic<std::size_t> waiting_;
+	std::atomic<std::size_t> generation_;
+};
+
+// ----------------------------------------------------------------------------
+//
+// Pins the calling thread to cpu; false if that is not possible.
+inline bool pin_current_thread(int cpu)
+{
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+// Parses a comma separated list of cpus, with a-b ranges.
+inline bool parse_cpu_list(std::string const& list, std::vector<int>& cpus)
+{
+	cpus.clear();
+	std::istringstream in(list);
+	std::string item;
+	while(std::getline(in, item, ','))
+	{
+		if(item.empty())
+			continue;
+
+		int first, last;
+		char dash;
+		std::istringstream range(item);
+		if(!(range >> first))
+			return false;
+
+		last = first;
+		if(range >> dash && !(dash == '-' && range >> last))
+			return false;
+
+		for(int cpu = first; cpu <= last; ++cpu)
+			cpus.push_back(cpu);
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------
+//
+class thread_team
+{
+public:
+	// Member i is pinned to cpus[i] when there is one. An empty list
+	// means the cpus the caller may run on, in order, so member i gets
+	// cpu i on an unrestricted host. The calling thread is member 0 and
+	// has its affinity restored when the team is destroyed.
+	thread_team(std::size_t size, std::vector<int> const& cpus)
+		: size_(size)
+		, start_(size)
+		, finish_(size)
+		, job_(nullptr)
+		, quit_(false)
+	{
+		std::vector<int> pinned = cpus;
+#ifdef __linux__
+		pthread_getaffinity_np(pthread_self(), sizeof(caller_affinity_), &caller_affinity_);
+		for(int cpu = 0; cpus.empty() && cpu < CPU_SETSIZE; ++cpu)
+		{
+			if(CPU_ISSET(cpu, &caller_affinity_))
+				pinned.push_back(cpu);
+		}
+#endif
+		if(!pinned.empty())
+			pin_current_thread(pinned[0]);
+
+		for(std::size_t i = 1; i < size_; ++i)
+		{
+			int cpu = i < pinned.size() ? pinned[i] : -1;
+			threads_.push_back(std::thread([this, i, cpu]
+			{
+				if(cpu >= 0)
+					pin_current_thread(cpu);
+
+				worker(i);
+			}));
+		}
+	}
+
+	~thread_team()
+	{
+		quit_.store(true, std::memory_order_relaxed);
+		start_.wait();
+		for(std::thread& t : threads_)
+			t.join();
+
+#ifdef __linux__
+		pthread_setaffinity_np(pthread_self(), sizeof(caller_affinity_), &caller_affinity_);
+#endif
+	}
+
+	thread_team(thread_team const&) = delete;
+	thread_team& operator=(thread_team const&) = delete;
+
+	std::size_t size() const
+	{
+		return size_;
+	}
+
+	void run(std::function<void(std::size_t)> const& job)
+	{
+		job_ = &job;
+		start_.wait();
+		job(0);
+		finish_.wait();
+	}
+
+private:
+	void worker(std::size_t index)
+	{
+		for(;;)
+		{
+			start_.wait();
+			if(quit_.load(std::memory_order_relaxed))
+				return;
+
+			(*job_)(index);
+			finish_.wait();
+		}
+	}
+
+	std::size_t const size_;
+	spin_barrier start_;
+	spin_barrier finish_;
+	std::function<void(std::size_t)> const* job_;
+	std::atomic<bool> quit_;
+	std::vector<std::thread> threads_;
+#ifdef __linux__
+	cpu_set_t caller_affinity_;
+#endif
+};
+
+// Splits count items into parts chunks whose boundaries are multiples
+// of granule, returning the half open range of chunk index.
+inline void partition(std::size_t count, std::size_t parts, std::size_t granule, std::size_t index, std::size_t& begin, std::size_t& end)
+{
+	std::size_t granules = (count + granule - 1) / granule;
+	std::size_t first = granules * index / parts;
+	std::size_t last = granules * (index + 1) / parts;
+	begin = std::min(count, first * granule);
+	end = std::min(count, last * granule);
+}
+
+#endif // SIMDPERF_THREADS_H_
@@ -0,0 +1,157 @@
+// timing.h
+//
+// Timing backends for the trial engine. The wall backend uses
+// cgutil::timer, the tsc backend brackets the measured region with
+// lfence-serialised rdtsc/rdtscp. Both have their own call overhead
+// measured once and subtracted from every sample, and both report in
+// seconds so the statistics stay comparable between backends.
+//
+// Cycle figures are TSC reference cycles. The TSC frequency is
+// calibrated against std::chrono::steady_clock on first use.
+
+#ifndef SIMDPERF_TIMING_H_
+#define SIMDPERF_TIMING_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#ifdef _MSC_VER
+#  include <intrin.h>
+#else
+#  include <x86intrin.h>
+#endif
+#include "cgutil/timer.h"
+
+// ----------------------------------------------------------------------------
+//
+enum class timing_backend
+{
+	wall,
+	tsc,
+};
+
+inline bool parse_timing_backend(std::string const& name, timing_backend& backend)
+{
+	if(name == "wall")
+		backend = timing_backend::wall;
+	else if(name == "tsc")
+		backend = timing_backend::tsc;
+	else
+		return false;
+
+	return true;
+}
+
+inline char const* timing_backend_name(timing_backend backend)
+{
+	return backend == timing_backend::tsc ? "tsc" : "wall";
+}
+
+// ----------------------------------------------------------------------------
+//
+inline std::uint64_t tsc_begin()
+{
+	_mm_lfence();
+	std::uint64_t t = __rdtsc();
+	_mm_lfence();
+	return t;
+}
+
+inline std::uint64_t tsc_end()
+{
+	unsigned int aux;
+	std::uint64_t t = __rdtscp(&aux);
+	_mm_lfence();
+	return t;
+}
+
+inline double calibrate_tsc_frequency()
+{
+	// Best of a few short windows; a preemption can only make a
+	// window look longer in wall time, never shorter.
+	double best = 0;
+	for(int i = 0; i < 5; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::uint64_t c0 = tsc_begin();
+		while(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20))
+		{}
+		std::uint64_t c1 = tsc_end();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		best = std::max(best, (c1 - c0) / seconds);
+	}
+
+	return best;
+}
+
+inline double tsc_frequency()
+{
+	static double const hz = calibrate_tsc_frequency();
+	return hz;
+}
+
+inline double seconds_to_cycles(double seconds)
+{
+	return seconds * tsc_frequency();
+}
+
+// ----------------------------------------------------------------------------
+//
+inline double measure_tsc_overhead()
+{
+	std::uint64_t best = ~std::uint64_t(0);
+	for(int i = 0; i < 1000; ++i)
+	{
+		std::uint64_t start = tsc_begin();
+		std::uint64_t stop = tsc_end();
+		best = std::min(best, stop - start);
+	}
+
+	return static_cast<double>(best);
+}
+
+inline double measure_wall_overhead()
+{
+	double best = 1;
+	for(int i = 0; i < 1000; ++i)
+	{
+		cgutil::timer t;
+		best = std::min(best, static_cast<double>(t.elapsed()));
+	}
+
+	return best;
+}
+
+inline double tsc_overhead()
+{
+	static double const cycles = measure_tsc_overhead();
+	return cycles;
+}
+
+inline double wall_overhead()
+{
+	static double const seconds = measure_wall_overhead();
+	return seconds;
+}
+
+// Runs fn once and returns its duration in seconds with the backend's
+// own overhead removed.
+template<typename Fn>
+double time_call(timing_backend backend, Fn& fn)
+{
+	if(backend == timing_backend::tsc)
+	{
+		std::uint64_t start = tsc_begin();
+		fn();
+		std::uint64_t stop = tsc_end();
+		double cycles = std::max(0.0, (stop - start) - tsc_overhead());
+		return cycles / tsc_frequency();
+	}
+
+	cgutil::timer t;
+	fn();
+	return std::max(0.0, t.elapsed() - wall_overhead());
+}
+
+#endif // SIMDPERF_TIMING_H_
@@ -0,0 +1,135 @@
+// trials.h
+//
+// Repeated-trial engine and summary statistics shared by the benchmarks.
+// A kernel is run a number of warmup trials that are discarded, followed
+// by the measured trials. Each measured trial produces one sample which
+// is then reduced to order statistics plus a bootstrap confidence
+// interval on the median.
+
+#ifndef SIMDPERF_TRIALS_H_
+#define SIMDPERF_TRIALS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <random>
+#include <vector>
+#include "timing.h"
+
+// ----------------------------------------------------------------------------
+//
+struct trial_stats
+{
+	std::size_t count = 0;
+	double min = 0;
+	double median = 0;
+	double mean = 0;
+	double p90 = 0;
+	double p99 = 0;
+	double stddev = 0;
+	double ci_low = 0;
+	double ci_high = 0;
+};
+
+// Linearly interpolated percentile, p in [0, 1]. Expects sorted input.
+inline double percentile(std::vector<double> const& sorted, double p)
+{
+	if(sorted.empty())
+		return 0;
+
+	double rank = p * (sorted.size() - 1);
+	std::size_t lo = static_cast<std::size_t>(rank);
+	std::size_t hi = std::min(lo + 1, sorted.size() - 1);
+	double frac = rank - lo;
+	return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+// Percentile bootstrap of the median. The generator is seeded with a
+// constant so that repeated reports over the same samples agree.
+inline void bootstrap_median(std::vector<double> const& samples, std::size_t resamples, double confidence, double& lo, double& hi)
+{
+	if(samples.size() < 2 || resamples == 0)
+	{
+		lo = hi = samples.empty() ? 0 : samples[0];
+		return;
+	}
+
+	std::mt19937 rng(0x5eed);
+	std::uniform_int_distribution<std::size_t> pick(0, samples.size() - 1);
+	std::vector<double> medians(resamples);
+	std::vector<double> resample(samples.size());
+	for(std::size_t r = 0; r < resamples; ++r)
+	{
+		for(std::size_t i = 0; i < resample.size(); ++i)
+			resample[i] = samples[pick(rng)];
+
+		std::sort(resample.begin(), resample.end());
+		medians[r] = percentile(resample, 0.5);
+	}
+
+	std::sort(medians.begin(), medians.end());
+	double tail = (1.0 - confidence) / 2;
+	lo = percentile(medians, tail);
+	hi = percentile(medians, 1.0 - tail);
+}
+
+inline trial_stats summarise(std::vector<double> samples, std::size_t resamples, double confidence)
+{
+	trial_stats stats;
+	stats.count = samples.size();
+	if(samples.empty())
+		return stats;
+
+	std::sort(samples.begin(), samples.end());
+	stats.min = samples.front();
+	stats.median = percentile(samples, 0.5);
+	stats.p90 = percentile(samples, 0.9);
+	stats.p99 = percentile(samples, 0.99);
+
+	double sum = 0;
+	for(double s : samples)
+		sum += s;
+	stats.mean = sum / samples.size();
+
+	double sq = 0;
+	for(double s : samples)
+		sq += (s - stats.mean) * (s - stats.mean);
+	stats.stddev = samples.size() > 1 ? std::sqrt(sq / (samples.size() - 1)) : 0;
+
+	bootstrap_median(samples, resamples, confidence, stats.ci_low, stats.ci_high);
+	return stats;
+}
+
+inline std::ostream& operator<<(std::ostream& out, trial_stats const& stats)
+{
+	return out << "median " << stats.median
+			   << " [" << stats.ci_low << ", " << stats.ci_high << "]"
+			   << " min " << stats.min
+			   << " mean " << stats.mean
+			   << " p90 " << stats.p90
+			   << " p99 " << stats.p99
+			   << " stddev " << stats.stddev
+			   << " (n=" << stats.count << ")"
+	;
+}
+
+// ----------------------------------------------------------------------------
+//
+template<typename Fn>
+std::vector<double> run_trials(timing_backend backend, std::size_t warmup, std::size_t trials, Fn&& fn)
+{
+	for(std::size_t i = 0; i < warmup; ++i)
+		fn();
+
+	std::vector<double> samples;
+	samples.reserve(trials);
+	for(std::size_t i = 0; i < trials; ++i)
+	{
+		samples.push_back(time_call(backend, fn));
+	}
+
+	return samples;
+}
+
+#endif // SIMDPERF_TRIALS_H_
@@ -0,0 +1,183 @@
+// vector-ops.h
+//
+// Vector traits for the generated kernels. Each ISA gets one struct with
+// its vector type, width in floats, load/store and arithmetic, where the
+// memory flavor is a template argument so a kernel template picks
+// aligned, unaligned or streaming access at compile time. Every op
+// carries its own target attribute and the kernels that use them need
+// the same one.
+// The 256 and 512 bit structs also have a fused fmadd; SSE has none.
+
+#ifndef SIMDPERF_VECTOR_OPS_H_
+#define SIMDPERF_VECTOR_OPS_H_
+
+#include <immintrin.h>
+#include "cpu-features.h"
+
+// ----------------------------------------------------------------------------
+//
+enum memory_flavor
+{
+	kAligned,
+	kUnaligned,
+	kStream, // aligned loads, non-temporal stores
+};
+
+// ----------------------------------------------------------------------------
+//
+struct sse_ops
+{
+	typedef __m128 type;
+	static int const width = 4;
+
+	template<int flavor>
+	SIMDPERF_TARGET("sse2") static type load(float const* p)
+	{
+		return flavor == kUnaligned ? _mm_loadu_ps(p) : _mm_load_ps(p);
+	}
+
+	template<int flavor>
+	SIMDPERF_TARGET("sse2") static void store(float* p, type v)
+	{
+		if(flavor == kUnaligned)
+			_mm_storeu_ps(p, v);
+		else if(flavor == kStream)
+			_mm_stream_ps(p, v);
+		else
+			_mm_store_ps(p, v);
+	}
+
+	SIMDPERF_TARGET("sse2") static type mul(type a, type b)
+	{
+		return _mm_mul_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("sse2") static type set1(float x)
+	{
+		return _mm_set1_ps(x);
+	}
+
+	SIMDPERF_TARGET("sse2") static type add(type a, type b)
+	{
+		return _mm_add_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("sse2") static type min(type a, type b)
+	{
+		return _mm_min_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("sse2") static type max(type a, type b)
+	{
+		return _mm_max_ps(a, b);
+	}
+};
+
+struct avx_ops
+{
+	typedef __m256 type;
+	static int const width = 8;
+
+	template<int flavor>
+	SIMDPERF_TARGET("avx") static type load(float const* p)
+	{
+		return flavor == kUnaligned ? _mm256_loadu_ps(p) : _mm256_load_ps(p);
+	}
+
+	template<int flavor>
+	SIMDPERF_TARGET("avx") static void store(float* p, type v)
+	{
+		if(flavor == kUnaligned)
+			_mm256_storeu_ps(p, v);
+		else if(flavor == kStream)
+			_mm256_stream_ps(p, v);
+		else
+			_mm256_store_ps(p, v);
+	}
+
+	SIMDPERF_TARGET("avx") static type mul(type a, type b)
+	{
+		return _mm256_mul_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("avx") static type set1(float x)
+	{
+		return _mm256_set1_ps(x);
+	}
+
+	SIMDPERF_TARGET("avx") static type add(type a, type b)
+	{
+		return _mm256_add_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("avx") static type min(type a, type b)
+	{
+		return _mm256_min_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("avx") static type max(type a, type b)
+	{
+		return _mm256_max_ps(a, b);
+	}
+
+	// a * b + c with one rounding; needs FMA3 on top of AVX.
+	SIMDPERF_TARGET("avx,fma") static type fmadd(type a, type b, type c)
+	{
+		return _mm256_fmadd_ps(a, b, c);
+	}
+};
+
+struct avx512_ops
+{
+	typedef __m512 type;
+	static int const width = 16;
+
+	template<int flavor>
+	SIMDPERF_TARGET("avx512f") static type load(float const* p)
+	{
+		return flavor == kUnaligned ? _mm512_loadu_ps(p) : _mm512_load_ps(p);
+	}
+
+	template<int flavor>
+	SIMDPERF_TARGET("avx512f") static void store(float* p, type v)
+	{
+		if(flavor == kUnaligned)
+			_mm512_storeu_ps(p, v);
+		else if(flavor == kStream)
+			_mm512_stream_ps(p, v);
+		else
+			_mm512_store_ps(p, v);
+	}
+
+	SIMDPERF_TARGET("avx512f") static type mul(type a, type b)
+	{
+		return _mm512_mul_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("avx512f") static type set1(float x)
+	{
+		return _mm512_set1_ps(x);
+	}
+
+	SIMDPERF_TARGET("avx512f") static type add(type a, type b)
+	{
+		return _mm512_add_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("avx512f") static type min(type a, type b)
+	{
+		return _mm512_min_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("avx512f") static type max(type a, type b)
+	{
+		return _mm512_max_ps(a, b);
+	}
+
+	SIMDPERF_TARGET("avx512f") static type fmadd(type a, type b, type c)
+	{
+		return _mm512_fmadd_ps(a, b, c);
+	}
+};
+
+#endif // SIMDPERF_VECTOR_OPS_H_